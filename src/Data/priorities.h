@@ -38,14 +38,23 @@ struct Priorities {
 };
 
 /**
- * @brief Interval and it's Entry
+ * @brief Properties of entry needed for scoring
+ *
+ */
+struct EntryProperties {
+    bool ignored; //!< Entry belongs to schedule ignored during generation
+    double bonus; //!< Bonus of entry
+};
+
+/**
+ * @brief Interval and properties of it's Entry
  *
  * Each entry can have multiple intervals, this way each interval is its own element
- * with link to entry it comes from.
+ * with properties of entry it comes from.
  *
  * @see Entry
  *
  */
-using IntervalEntry = std::pair<TimeInterval, std::shared_ptr<Entry>>;
+using IntervalEntry = std::pair<TimeInterval, EntryProperties>;
 
 #endif /* PRIORITIES_H */
\ No newline at end of file
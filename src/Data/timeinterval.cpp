@@ -1,5 +1,7 @@
 #include "timeinterval.h"
 
+#include <algorithm>
+
 TimeInterval::TimeStamp::TimeStamp(uint32_t h, uint32_t m) : hour(h), minute(m) {
     if (h >= 24 || m >= 60) {
         throw std::invalid_argument("TimeStamp hour or minute is larger than possible.");
@@ -38,6 +40,19 @@ bool TimeInterval::operator > (const TimeInterval & rhs) const {
     return rhs < *this;
 }
 
+bool TimeInterval::collidesWith(const TimeInterval & other) const {
+    if (day != other.day) {
+        return false;
+    }
+
+    // Overlap if the later start is before the earlier end
+    if (!(std::max(startTime, other.startTime) < std::min(endTime, other.endTime))) {
+        return false;
+    }
+
+    return parity == other.parity || parity == Parity::Both || other.parity == Parity::Both;
+}
+
 TimeInterval::TimeInterval(const enum Day & d, const TimeStamp & s, const TimeStamp & e,
     const Parity & p) :
     day(d), startTime(s), endTime(e), parity(p) {
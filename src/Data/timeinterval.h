@@ -100,6 +100,18 @@ public:
     bool operator < (const TimeInterval & rhs) const;
     bool operator > (const TimeInterval & rhs) const;
 
+    /**
+     * @brief Check if intervals collide
+     *
+     * Intervals collide if they overlap in the same day and
+     * share parity (or at least one of them is in both parities).
+     *
+     * @param other other interval
+     * @return true intervals collide
+     * @return false intervals don't collide
+     */
+    bool collidesWith(const TimeInterval & other) const;
+
 };
 
 #endif /* TIMEINTERVAL_H */
\ No newline at end of file
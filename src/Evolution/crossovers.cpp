@@ -1,55 +1,86 @@
 #include "crossovers.h"
 
-CrossoverException::CrossoverException(std::string message) : msg(std::move(message)) { }
+#include "Utility/cpu.h"
 
-const char * CrossoverException::what() const noexcept {
-    return msg.c_str();
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Number of genes blended at once by vector blend
+#define CROSSOVER_GENES_IN_VECTOR 8
+
+// Blend of genes from two parents, selected by bits of mask (zero bit for left parent)
+
+static void blendScalar(const uint32_t * lhs, const uint32_t * rhs, uint32_t * result, RANDOM_CROSSOVER_NUMBER_TYPE mask, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t select = 0u - static_cast<uint32_t>((mask >> i) & 1);
+        result[i] = lhs[i] ^ ((lhs[i] ^ rhs[i]) & select);
+    }
 }
 
-size_t Crossover::genomeCheck(const Genome & lParent, const Genome & rParent) const {
-    if (lParent.size() != rParent.size()) {
-        throw CrossoverException("Crossover got parents with different genome lengths.");
+#if defined(__x86_64__)
+
+__attribute__((target("avx2")))
+static void blendAvx2(const uint32_t * lhs, const uint32_t * rhs, uint32_t * result, RANDOM_CROSSOVER_NUMBER_TYPE mask, size_t count) {
+    // Each lane tests its own bit of a byte of mask
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+    size_t i = 0;
+    for (; i + CROSSOVER_GENES_IN_VECTOR <= count; i += CROSSOVER_GENES_IN_VECTOR) {
+        __m256i selector = _mm256_set1_epi32(static_cast<int>((mask >> i) & 0xFF));
+        __m256i select = _mm256_cmpeq_epi32(_mm256_and_si256(selector, bits), bits);
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), _mm256_blendv_epi8(l, r, select));
     }
 
-    return lParent.size();
+    if (i < count) {
+        blendScalar(lhs + i, rhs + i, result + i, mask >> i, count - i);
+    }
 }
 
-RANDOM_CROSSOVER_NUMBER_TYPE Crossover::randomNumber() {
-    static std::random_device device;
-    static std::mt19937 rng(device());
-    static std::uniform_int_distribution<RANDOM_CROSSOVER_NUMBER_TYPE> distribution(0, INT32_MAX);
+#endif
 
-    return distribution(rng);
-}
+static void blend(const uint32_t * lhs, const uint32_t * rhs, uint32_t * result, RANDOM_CROSSOVER_NUMBER_TYPE mask, size_t count) {
+#if defined(__x86_64__)
+    if (hasAvx2()) {
+        blendAvx2(lhs, rhs, result, mask, count);
+        return;
+    }
+#endif
 
-Genome UniformCrossover::perform(const Genome & lParent, const Genome & rParent) const {
-    size_t genomeSize = genomeCheck(lParent, rParent);
+    blendScalar(lhs, rhs, result, mask, count);
+}
 
-    Genome descendant; // Child
+CrossoverException::CrossoverException(std::string message) : msg(std::move(message)) { }
 
-    size_t randomNumBit = 0;
-    uint32_t randomNum = randomNumber();
-    for (size_t i = 0; i < genomeSize; i++) {
+const char * CrossoverException::what() const noexcept {
+    return msg.c_str();
+}
 
-        if (randomNumBit == RANDOM_CROSSOVER_NUMBER_SIZE) { // If taken all of bits from generated number,
-        // generate new number
-            randomNum = randomNumber();
-            randomNumBit = 0;
-        }
+size_t Crossover::genomeCheck(GenomeView lParent, GenomeView rParent, GenomeView child) const {
+    if (lParent.size() != rParent.size()) {
+        throw CrossoverException("Crossover got parents with different genome lengths.");
+    }
+    if (child.size() != lParent.size()) {
+        throw CrossoverException("Crossover got child with different genome length.");
+    }
 
-        unsigned short bit = (randomNum >>= 1) & 1; // Take one bit from generated number
+    return lParent.size();
+}
 
-        // Assign gene to child from parent based on bit value
-        if (bit == 0) {
-            descendant.push_back(lParent[i]);
-        } else {
-            descendant.push_back(rParent[i]);
-        }
+void UniformCrossover::perform(GenomeView lParent, GenomeView rParent, GenomeBuffer child, Random & random) const {
+    size_t genomeSize = genomeCheck(lParent, rParent, child);
 
-        randomNumBit++;
+    // Each random number selects parents of a chunk of genes, one bit for each gene
+    for (size_t start = 0; start < genomeSize; start += RANDOM_CROSSOVER_NUMBER_SIZE) {
+        RANDOM_CROSSOVER_NUMBER_TYPE mask = random.next();
+        size_t count = std::min<size_t>(RANDOM_CROSSOVER_NUMBER_SIZE, genomeSize - start);
+        blend(lParent.data() + start, rParent.data() + start, child.data() + start, mask, count);
     }
-
-    return descendant;
 }
 
 PointCrossover::PointCrossover(size_t k) : Crossover(), points(k) {
@@ -58,37 +89,36 @@ PointCrossover::PointCrossover(size_t k) : Crossover(), points(k) {
     }
 }
 
-Genome PointCrossover::perform(const Genome & lParent, const Genome & rParent) const {
-    size_t genomeSize = genomeCheck(lParent, rParent);
+void PointCrossover::perform(GenomeView lParent, GenomeView rParent, GenomeBuffer child, Random & random) const {
+    size_t genomeSize = genomeCheck(lParent, rParent, child);
 
     if (points >= genomeSize) {
         throw CrossoverException("Length of genome too small for multi-point crossover.");
     }
 
-    // Generate random crossover points
-    std::set<size_t> crossoverPoints;
+    // Generate distinct random crossover points, kept sorted in buffer reused by each thread
+    thread_local std::vector<size_t> crossoverPoints;
+    crossoverPoints.clear();
     while (crossoverPoints.size() < points) { // Keep generating until required amount
-        size_t point = randomNumber() % genomeSize;
-        crossoverPoints.insert(point);
+        size_t point = random.below(genomeSize);
+        auto position = std::lower_bound(crossoverPoints.begin(), crossoverPoints.end(), point);
+        if (position == crossoverPoints.end() || *position != point) {
+            crossoverPoints.insert(position, point);
+        }
     }
 
-    Genome descendant;
-
+    // Copy segments between crossover points, swapping parent at each point
     bool parentParity = true;
-    for (size_t i = 0; i < genomeSize; i++) { // Go through genomes
-
-        // If in crossover point, swap parent from which will be genes taken
-        if (crossoverPoints.contains(i)) {
-            parentParity = !parentParity;
-        }
-
-        // Assign gene from parent based on current parity
-        if (parentParity) {
-            descendant.push_back(lParent[i]);
-        } else {
-            descendant.push_back(rParent[i]);
-        }
+    size_t start = 0;
+    auto copySegment = [ & ] (size_t end) {
+        const uint32_t * parent = parentParity ? lParent.data() : rParent.data();
+        std::memcpy(child.data() + start, parent + start, (end - start) * sizeof(uint32_t));
+        };
+
+    for (size_t point : crossoverPoints) {
+        copySegment(point);
+        parentParity = !parentParity;
+        start = point;
     }
-
-    return descendant;
-}
\ No newline at end of file
+    copySegment(genomeSize);
+}
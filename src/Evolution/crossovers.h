@@ -12,16 +12,18 @@
 #ifndef CROSSOVERS_H
 #define CROSSOVERS_H
 
+#include "Evolution/random.h"
+
 #include <vector>
 #include <utility>
 #include <cstdint>
-#include <random>
 #include <exception>
-#include <set>
+#include <string>
+#include <span>
 
 
-#define RANDOM_CROSSOVER_NUMBER_TYPE uint32_t //!< Type for random number
-#define RANDOM_CROSSOVER_NUMBER_SIZE 32 //!< Size of type for random number
+#define RANDOM_CROSSOVER_NUMBER_TYPE uint64_t //!< Type for random number
+#define RANDOM_CROSSOVER_NUMBER_SIZE 64 //!< Size of type for random number
 
 /**
  * @brief Genome
@@ -29,6 +31,18 @@
  */
 using Genome = std::vector<uint32_t>;
 
+/**
+ * @brief Read-only genes of a genome, wherever they are stored
+ *
+ */
+using GenomeView = std::span<const uint32_t>;
+
+/**
+ * @brief Preallocated storage for genes of a genome
+ *
+ */
+using GenomeBuffer = std::span<uint32_t>;
+
 /**
  * @brief Exception thrown by crossover
  *
@@ -59,40 +73,36 @@ struct Crossover {
      *
      * @param lParent parent genome
      * @param rParent parent genome
-     * @return Genome child genome
+     * @param[out] child storage for child genome, same length as parents
+     * @param random random number generator of the calling worker
      */
-    virtual Genome perform(const Genome & lParent, const Genome & rParent) const = 0;
+    virtual void perform(GenomeView lParent, GenomeView rParent, GenomeBuffer child, Random & random) const = 0;
 
 protected:
 
     /**
-     * @brief Check if genomes of parents are correct
+     * @brief Check if genomes of parents and child are correct
      *
-     * @throws CrossoverException if parents got different genome lengths
+     * @throws CrossoverException if parents or child got different genome lengths
      *
      * @param lParent parent genome
      * @param rParent parent genome
+     * @param child child genome
      * @return size_t genome length
      */
-    size_t genomeCheck(const Genome & lParent, const Genome & rParent) const;
-
-    /**
-     * @brief Random number
-     *
-     * @return RANDOM_CROSSOVER_NUMBER_TYPE random number
-     */
-    static RANDOM_CROSSOVER_NUMBER_TYPE randomNumber();
+    size_t genomeCheck(GenomeView lParent, GenomeView rParent, GenomeView child) const;
 };
 
 /**
  * @brief Uniform crossover operation
  *
  * Each gene of resulting genome is chosen from eighter parent with equal probabilty.
+ * Genes are blended in chunks, each selected by bits of one 64-bit random number.
  *
  */
 struct UniformCrossover : Crossover {
 
-    Genome perform(const Genome & lParent, const Genome & rParent) const override;
+    void perform(GenomeView lParent, GenomeView rParent, GenomeBuffer child, Random & random) const override;
 };
 
 /**
@@ -101,6 +111,7 @@ struct UniformCrossover : Crossover {
  * K-point crossover. Crossover points are picked randomly in genome.
  * Genes to one side of crossover point (to end of genome or another crossover point)
  * are taken from one parent, genes on other side are taken from other parent.
+ * Segments between sorted crossover points are copied whole.
  *
  */
 struct PointCrossover : Crossover {
@@ -124,9 +135,10 @@ public:
      *
      * @param lParent parent genome
      * @param rParent parent genome
-     * @return Genome child genome
+     * @param[out] child storage for child genome, same length as parents
+     * @param random random number generator of the calling worker
      */
-    Genome perform(const Genome & lParent, const Genome & rParent) const override;
+    void perform(GenomeView lParent, GenomeView rParent, GenomeBuffer child, Random & random) const override;
 };
 
 #endif /* CROSSOVERS_H */
\ No newline at end of file
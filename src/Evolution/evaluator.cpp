@@ -0,0 +1,292 @@
+#include "evaluator.h"
+
+#include <algorithm>
+#include <utility>
+
+// Default score to add for any start time out of prefferred bounds (see WrongStartTimesScore)
+#define EVALUATOR_WRONGSTARTTIMEDEFAULT 60
+
+bool ScoreEvaluator::DayInterval::operator < (const DayInterval & rhs) const {
+    return std::tie(start, end) < std::tie(rhs.start, rhs.end);
+}
+
+ScoreEvaluator::ScoreEvaluator(const ProblemModel & problem, const Priorities & p) :
+    priorities(p),
+    criteria(Scores::enabledCriteria(p)),
+    dayKernel(),
+    timeCount(0),
+    offsets(),
+    entryIntervals(),
+    entryBonuses() {
+
+    // Compress all start and end times, so they can be used as keys of counting sort
+    std::vector<uint32_t> times;
+    for (size_t entry = 0; entry < problem.getEntryCount(); entry++) {
+        for (auto & timeslot : problem.timeslots(entry)) {
+            times.push_back(timeslot.startTime.valueInMinutes());
+            times.push_back(timeslot.endTime.valueInMinutes());
+        }
+    }
+    std::sort(times.begin(), times.end());
+    times.erase(std::unique(times.begin(), times.end()), times.end());
+    timeCount = times.size();
+
+    auto rank = [ & ] (uint32_t time) -> uint16_t {
+        return static_cast<uint16_t>(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+        };
+
+    // Flatten intervals and bonuses of all entries of all genes
+    for (size_t gene = 0; gene < problem.getGeneCount(); gene++) {
+        offsets.push_back(entryIntervals.size());
+        bool ignored = problem.isIgnored(gene);
+
+        for (uint32_t value = 0; value < problem.valueCount(gene); value++) {
+            size_t entry = problem.entryIndex(gene, value);
+
+            std::vector<std::pair<size_t, DayInterval>> intervals;
+            for (auto & timeslot : problem.timeslots(entry)) {
+                uint32_t start = timeslot.startTime.valueInMinutes();
+                uint32_t end = timeslot.endTime.valueInMinutes();
+                DayInterval interval { start, end, timeslot.parity, static_cast<uint32_t>(gene), rank(start), rank(end), ignored };
+                intervals.emplace_back(static_cast<size_t>(timeslot.day), interval);
+            }
+            entryIntervals.push_back(intervals);
+
+            entryBonuses.push_back(ignored ? 0 : problem.bonus(entry) * problem.timeslots(entry).size());
+        }
+    }
+
+    // Choose day kernel for enabled criteria
+    unsigned features = 0;
+    if (p.keepCoherentInDay) {
+        features |= KERNEL_GAPS;
+    }
+    if (p.penaliseBeforeHour != 0) {
+        features |= KERNEL_STARTS_BEFORE;
+    }
+    if (p.penaliseAfterHour != 0) {
+        features |= KERNEL_STARTS_AFTER;
+    }
+    if (p.penaliseManyConsecutiveHours != 0) {
+        features |= KERNEL_RUNS;
+    }
+    dayKernel = kernelFor(features);
+}
+
+Scores ScoreEvaluator::evaluate(GenomeView genome, Workspace & workspace) const {
+    double bonuses = fillDays(genome, workspace);
+    DayBuckets & days = workspace.days;
+
+    std::array<size_t, 7> sizes;
+    for (size_t day = 0; day < 7; day++) {
+        sizes[day] = days[day].size();
+    }
+
+    size_t first = firstDay(sizes);
+    std::array<DayScores, 7> partial;
+    for (size_t day = 0; day < 7; day++) {
+        partial[day] = evaluateDay(days[day], day == first);
+    }
+
+    return composeScores(partial, bonuses);
+}
+
+double ScoreEvaluator::fillDays(GenomeView genome, Workspace & workspace) const {
+    auto & gathered = workspace.gathered;
+    auto & ordered = workspace.ordered;
+    auto & counts = workspace.counts;
+
+    // Gather intervals of selected entries
+    gathered.clear();
+    double bonuses = 0;
+    for (size_t gene = 0; gene < genome.size(); gene++) {
+        size_t entry = offsets[gene] + genome[gene];
+        gathered.insert(gathered.end(), entryIntervals[entry].begin(), entryIntervals[entry].end());
+        bonuses += entryBonuses[entry];
+    }
+
+    // Sort by end time
+    counts.assign(timeCount + 1, 0);
+    for (auto & [ day, interval ] : gathered) {
+        counts[interval.endRank + 1]++;
+    }
+    for (size_t i = 1; i <= timeCount; i++) {
+        counts[i] += counts[i - 1];
+    }
+    ordered.resize(gathered.size());
+    for (auto & item : gathered) {
+        ordered[counts[item.second.endRank]++] = item;
+    }
+
+    // Stable sort by day and start time, each day is written into its bucket
+    counts.assign(7 * timeCount + 1, 0);
+    for (auto & [ day, interval ] : ordered) {
+        counts[day * timeCount + interval.startRank + 1]++;
+    }
+    for (size_t day = 0; day < 7; day++) {
+        // Positions are relative to the start of each day
+        for (size_t i = day * timeCount + 1; i <= (day + 1) * timeCount; i++) {
+            counts[i] += counts[i - 1];
+        }
+        workspace.days[day].resize(counts[(day + 1) * timeCount]);
+        if (day < 6) {
+            counts[(day + 1) * timeCount] = 0;
+        }
+    }
+    for (auto & [ day, interval ] : ordered) {
+        workspace.days[day][counts[day * timeCount + interval.startRank]++] = interval;
+    }
+
+    return bonuses;
+}
+
+const std::vector<std::pair<size_t, ScoreEvaluator::DayInterval>> & ScoreEvaluator::intervalsOf(size_t gene, uint32_t value) const {
+    return entryIntervals[offsets[gene] + value];
+}
+
+double ScoreEvaluator::bonusOf(size_t gene, uint32_t value) const {
+    return entryBonuses[offsets[gene] + value];
+}
+
+ScoreEvaluator::DayScores ScoreEvaluator::evaluateDay(const std::vector<DayInterval> & intervals, bool seeded) const {
+    return (this->*dayKernel)(intervals, seeded);
+}
+
+template<unsigned Features>
+ScoreEvaluator::DayScores ScoreEvaluator::evaluateDayWith(const std::vector<DayInterval> & intervals, bool seeded) const {
+    DayScores result;
+
+    uint32_t beforeBound = priorities.penaliseBeforeHour * 60;
+    uint32_t afterBound = priorities.penaliseAfterHour * 60;
+
+    // Consecutive run, the first day of genome starts with its first interval
+    // even if it is ignored (matches ManyConsecutiveHoursScore)
+    uint32_t limit = priorities.penaliseManyConsecutiveHours;
+    bool running = seeded && !intervals.empty();
+    uint32_t runStart = running ? intervals.front().start : 0;
+    uint32_t runEnd = running ? intervals.front().end : 0;
+    auto closeRun = [ & ] () {
+        uint32_t length = runEnd - runStart;
+        if (length / 60 > limit) {
+            result.consecutiveMinutes += length - limit * 60;
+        }
+        };
+
+    for (auto it = intervals.begin(); it != intervals.end(); it++) {
+        if (it->ignored) {
+            continue;
+        }
+        result.counted++;
+
+        // Collisions with following intervals that start before this one ends
+        for (auto other = it + 1; other != intervals.end() && other->start < it->end; other++) {
+            if (other->ignored) {
+                continue;
+            }
+
+            if (it->parity == other->parity
+                || it->parity == TimeInterval::Parity::Both || other->parity == TimeInterval::Parity::Both) {
+                result.collisions++;
+            }
+        }
+
+        // Gap to the next interval that is not ignored
+        if constexpr ((Features & KERNEL_GAPS) != 0) {
+            auto next = it + 1;
+            while (next != intervals.end() && next->ignored) {
+                next++;
+            }
+            if (next != intervals.end() && next->start >= it->end
+                && next->start - it->end >= priorities.minutesToBeConsecutive) {
+                result.incoherences++;
+            }
+        }
+
+        // Start out of preferred bounds
+        if constexpr ((Features & KERNEL_STARTS_BEFORE) != 0) {
+            if (it->start <= beforeBound) {
+                result.wrongStartTimes += EVALUATOR_WRONGSTARTTIMEDEFAULT + (beforeBound - it->start);
+            }
+        }
+        if constexpr ((Features & KERNEL_STARTS_AFTER) != 0) {
+            if (it->start >= afterBound) {
+                result.wrongStartTimes += EVALUATOR_WRONGSTARTTIMEDEFAULT + (it->start - afterBound);
+            }
+        }
+
+        // Extend current run or start a new one (overlapping start also starts a new one)
+        if constexpr ((Features & KERNEL_RUNS) != 0) {
+            if (!running) {
+                running = true;
+                runStart = it->start;
+                runEnd = it->end;
+            } else if (it->start < runEnd || it->start - runEnd > priorities.minutesToBeConsecutive) {
+                closeRun();
+                runStart = it->start;
+                runEnd = it->end;
+            } else {
+                runEnd = it->end;
+            }
+        }
+    }
+
+    if constexpr ((Features & KERNEL_RUNS) != 0) {
+        if (running) {
+            closeRun();
+        }
+    }
+
+    return result;
+}
+
+ScoreEvaluator::DayKernel ScoreEvaluator::kernelFor(unsigned features) {
+    // Instantiate kernel for each combination of features
+    static constexpr auto kernels = [ ] <size_t... Features> (std::index_sequence<Features...>) {
+        return std::array<DayKernel, sizeof...(Features)> { &ScoreEvaluator::evaluateDayWith<Features>... };
+        }(std::make_index_sequence<KERNEL_FEATURE_COMBINATIONS>());
+
+    return kernels[features];
+}
+
+Scores ScoreEvaluator::composeScores(const std::array<DayScores, 7> & partial, double bonusSum) const {
+    DayScores total;
+    size_t firstCounted = 7;
+    size_t lastCounted = 0;
+    for (size_t day = 0; day < 7; day++) {
+        total.collisions += partial[day].collisions;
+        total.incoherences += partial[day].incoherences;
+        total.consecutiveMinutes += partial[day].consecutiveMinutes;
+        total.wrongStartTimes += partial[day].wrongStartTimes;
+
+        if (partial[day].counted != 0) {
+            firstCounted = std::min(firstCounted, day);
+            lastCounted = day;
+        }
+    }
+
+    Scores result(criteria);
+    auto set = [ & ] (Criterion criterion, double value) {
+        if (result.isEnabled(criterion)) {
+            result[criterion] = value;
+        }
+        };
+
+    set(Criterion::Collisions, total.collisions);
+    set(Criterion::Bonuses, bonusSum);
+    set(Criterion::CoherentInDay, total.incoherences);
+    set(Criterion::CoherentInWeek, (firstCounted < 7) ? lastCounted - firstCounted : 0);
+    set(Criterion::WrongStartTime, total.wrongStartTimes);
+    set(Criterion::ManyConsecutiveHours, total.consecutiveMinutes);
+
+    return result;
+}
+
+size_t ScoreEvaluator::firstDay(const std::array<size_t, 7> & sizes) {
+    for (size_t day = 0; day < 7; day++) {
+        if (sizes[day] != 0) {
+            return day;
+        }
+    }
+
+    return 7;
+}
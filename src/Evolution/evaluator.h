@@ -0,0 +1,207 @@
+/**
+ * @file evaluator.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Fused single-pass calculation of all scores
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "Data/priorities.h"
+#include "Evolution/crossovers.h"
+#include "Evolution/problem.h"
+#include "Evolution/scores.h"
+
+#include <vector>
+#include <array>
+
+/**
+ * @brief Fused calculation of all enabled criteria
+ *
+ * Intervals of selected entries are distributed into sorted per-day buckets,
+ * each day is then traversed once, calculating all criteria together.
+ *
+ * Scores are identical to scores calculated by the reference Score classes,
+ * including their quirks (see evaluateDay).
+ *
+ * Day kernel is instantiated for each combination of enabled criteria, the one matching
+ * priorities is chosen on construction, so its loop has no checks of disabled criteria.
+ *
+ */
+class ScoreEvaluator {
+public:
+
+    /**
+     * @brief Interval of selected entry in a day
+     *
+     */
+    struct DayInterval {
+        uint32_t start; //!< Start time in minutes
+        uint32_t end; //!< End time in minutes
+        TimeInterval::Parity parity; //!< Parity of weeks
+        uint32_t gene; //!< Index of gene that selected this interval
+        uint16_t startRank; //!< Index of start time in all distinct times of the problem
+        uint16_t endRank; //!< Index of end time in all distinct times of the problem
+        bool ignored; //!< Interval belongs to ignored schedule
+
+        bool operator < (const DayInterval & rhs) const;
+    };
+
+    /**
+     * @brief Partial scores of a day
+     *
+     */
+    struct DayScores {
+        double collisions = 0; //!< Collisions in day
+        double incoherences = 0; //!< Gaps in day
+        double consecutiveMinutes = 0; //!< Minutes over limit of consecutive hours
+        double wrongStartTimes = 0; //!< Penalty for start times
+        size_t counted = 0; //!< Intervals that are not ignored
+    };
+
+    using DayBuckets = std::array<std::vector<DayInterval>, 7>; //!< Sorted intervals of each day
+
+    /**
+     * @brief Buffers reused between evaluations (one for each thread)
+     *
+     */
+    struct Workspace {
+        DayBuckets days; //!< Sorted intervals of each day
+        std::vector<std::pair<size_t, DayInterval>> gathered; //!< Day and interval of each timeslot of genome
+        std::vector<std::pair<size_t, DayInterval>> ordered; //!< Timeslots of genome sorted by end time
+        std::vector<uint32_t> counts; //!< Counts of keys for counting sort
+    };
+
+private:
+
+    /**
+     * @brief Parts of day kernel enabled by priorities
+     *
+     */
+    enum KernelFeature : unsigned {
+        KERNEL_GAPS = 1, // Gaps in day (CoherentInDayScore)
+        KERNEL_STARTS_BEFORE = 2, // Starts before preferred hour (WrongStartTimesScore)
+        KERNEL_STARTS_AFTER = 4, // Starts after preferred hour (WrongStartTimesScore)
+        KERNEL_RUNS = 8, // Consecutive runs (ManyConsecutiveHoursScore)
+        KERNEL_FEATURE_COMBINATIONS = 16
+    };
+
+    using DayKernel = DayScores (ScoreEvaluator::*)(const std::vector<DayInterval> &, bool) const;
+
+    Priorities priorities;
+    CriteriaMask criteria; // Enabled criteria
+    DayKernel dayKernel; // Day kernel specialised for enabled features
+
+    size_t timeCount; // Number of distinct start and end times
+    std::vector<size_t> offsets; // Index of first entry of each gene in entry tables
+    std::vector<std::vector<std::pair<size_t, DayInterval>>> entryIntervals; // Day and interval of each timeslot of each entry
+    std::vector<double> entryBonuses; // Bonus of each entry (counted for each of its timeslots)
+
+public:
+
+    ScoreEvaluator() = delete;
+
+    /**
+     * @brief Construct a new Score Evaluator object
+     *
+     * @param problem flat model of schedules of genome
+     * @param p priorities for timetable generation
+     */
+    ScoreEvaluator(const ProblemModel & problem, const Priorities & p);
+
+    /**
+     * @brief Calculate scores of genome
+     *
+     * @param genome genome
+     * @param workspace buffers for intervals of genome, reused between calls
+     * @return Scores scores
+     */
+    Scores evaluate(GenomeView genome, Workspace & workspace) const;
+
+    /**
+     * @brief Distribute intervals of genome into sorted days
+     *
+     * Intervals are sorted by counting sort, first by rank of their end time, then by day
+     * and rank of their start time, so no comparisons are needed.
+     *
+     * @param genome genome
+     * @param[out] workspace buffers for intervals, sorted intervals of each day are in its days
+     * @return double sum of bonuses of genome
+     */
+    double fillDays(GenomeView genome, Workspace & workspace) const;
+
+    /**
+     * @brief Get days and intervals of entry
+     *
+     * @param gene index of gene
+     * @param value index of entry in its schedule
+     * @return const std::vector<std::pair<size_t, DayInterval>>& day and interval of each timeslot
+     */
+    const std::vector<std::pair<size_t, DayInterval>> & intervalsOf(size_t gene, uint32_t value) const;
+
+    /**
+     * @brief Get bonus of entry
+     *
+     * @param gene index of gene
+     * @param value index of entry in its schedule
+     * @return double bonus counted for each timeslot (zero if ignored)
+     */
+    double bonusOf(size_t gene, uint32_t value) const;
+
+    /**
+     * @brief Calculate partial scores of a day in one traversal
+     *
+     * ManyConsecutiveHoursScore starts its first run with the first interval of the timetable
+     * even if it is ignored, so the first day of genome has to be marked as seeded.
+     *
+     * @param intervals sorted intervals of the day
+     * @param seeded whether the day is the first day of genome
+     * @return DayScores partial scores
+     */
+    DayScores evaluateDay(const std::vector<DayInterval> & intervals, bool seeded) const;
+
+    /**
+     * @brief Sum partial scores into scores
+     *
+     * @param partial partial scores of each day
+     * @param bonusSum sum of bonuses
+     * @return Scores scores
+     */
+    Scores composeScores(const std::array<DayScores, 7> & partial, double bonusSum) const;
+
+    /**
+     * @brief First day containing any interval
+     *
+     * @param sizes number of intervals in each day
+     * @return size_t index of day (7 if there are none)
+     */
+    static size_t firstDay(const std::array<size_t, 7> & sizes);
+
+private:
+
+    /**
+     * @brief Calculate partial scores of a day, with only given features compiled in
+     *
+     * @tparam Features enabled features (KernelFeature)
+     * @param intervals sorted intervals of the day
+     * @param seeded whether the day is the first day of genome
+     * @return DayScores partial scores
+     */
+    template<unsigned Features>
+    DayScores evaluateDayWith(const std::vector<DayInterval> & intervals, bool seeded) const;
+
+    /**
+     * @brief Day kernel for given features
+     *
+     * @param features enabled features (KernelFeature)
+     * @return DayKernel kernel
+     */
+    static DayKernel kernelFor(unsigned features);
+};
+
+#endif /* EVALUATOR_H */
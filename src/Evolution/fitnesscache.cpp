@@ -0,0 +1,96 @@
+#include "fitnesscache.h"
+
+#include <algorithm>
+
+// Number of locks guarding cache slots (power of two)
+#define FITNESS_CACHE_LOCK_COUNT 64
+
+GenomeHasher::GenomeHasher(const std::vector<size_t> & valueCounts, uint64_t seed) : offsets(), keys() {
+    Random random(seed);
+
+    for (size_t count : valueCounts) {
+        offsets.push_back(keys.size());
+        for (size_t i = 0; i < count; i++) {
+            keys.push_back(random.next());
+        }
+    }
+}
+
+uint64_t GenomeHasher::hash(GenomeView genome) const {
+    uint64_t result = 0;
+    for (size_t i = 0; i < genome.size(); i++) {
+        result ^= keys[offsets[i] + genome[i]];
+    }
+
+    return result;
+}
+
+uint64_t GenomeHasher::update(uint64_t hash, size_t index, uint32_t from, uint32_t to) const {
+    return hash ^ keys[offsets[index] + from] ^ keys[offsets[index] + to];
+}
+
+uint64_t GenomeHasher::update(uint64_t hash, GenomeView original, GenomeView derived) const {
+    for (size_t i = 0; i < derived.size(); i++) {
+        if (original[i] != derived[i]) {
+            hash = update(hash, i, original[i], derived[i]);
+        }
+    }
+
+    return hash;
+}
+
+FitnessCache::FitnessCache(size_t capacity) :
+    slots(),
+    locks(new std::mutex[FITNESS_CACHE_LOCK_COUNT]),
+    hits(0),
+    misses(0) {
+
+    // Round capacity down to power of two, so slot can be taken from lowest bits of hash
+    size_t size = 1;
+    while (size * 2 <= capacity) {
+        size *= 2;
+    }
+    if (capacity != 0) {
+        slots.resize(size);
+    }
+}
+
+std::optional<Scores> FitnessCache::find(GenomeView genome, uint64_t hash) {
+    if (slots.empty()) {
+        return std::nullopt;
+    }
+
+    size_t index = hash & (slots.size() - 1);
+    {
+        std::lock_guard<std::mutex> lock(lockFor(index));
+        const Slot & slot = slots[index];
+        if (slot.scores.has_value() && slot.hash == hash && std::equal(slot.genome.begin(), slot.genome.end(), genome.begin(), genome.end())) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return slot.scores;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+void FitnessCache::store(GenomeView genome, uint64_t hash, const Scores & scores) {
+    if (slots.empty()) {
+        return;
+    }
+
+    size_t index = hash & (slots.size() - 1);
+    std::lock_guard<std::mutex> lock(lockFor(index));
+    Slot & slot = slots[index];
+    slot.hash = hash;
+    slot.genome.assign(genome.begin(), genome.end());
+    slot.scores = scores;
+}
+
+CacheStatistics FitnessCache::getStatistics() const {
+    return CacheStatistics { hits.load(), misses.load(), slots.size() };
+}
+
+std::mutex & FitnessCache::lockFor(size_t slot) const {
+    return locks[slot & (FITNESS_CACHE_LOCK_COUNT - 1)];
+}
@@ -0,0 +1,166 @@
+/**
+ * @file fitnesscache.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Hashing of genomes and cache of their scores
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef FITNESSCACHE_H
+#define FITNESSCACHE_H
+
+#include "Evolution/crossovers.h"
+#include "Evolution/scores.h"
+#include "Evolution/random.h"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <memory>
+
+/**
+ * @brief Zobrist hashing of genomes
+ *
+ * Each value of each gene has its own random key, hash of genome is xor of keys
+ * of its genes. Changing a gene changes the hash by xor of two keys,
+ * so hash can be updated without rehashing the whole genome.
+ *
+ */
+class GenomeHasher {
+
+    std::vector<size_t> offsets; // Index of first key for each gene
+    std::vector<uint64_t> keys; // Keys for all values of all genes
+
+public:
+
+    GenomeHasher() = delete;
+
+    /**
+     * @brief Construct a new Genome Hasher object
+     *
+     * @param valueCounts number of possible values of each gene
+     * @param seed seed of keys
+     */
+    GenomeHasher(const std::vector<size_t> & valueCounts, uint64_t seed);
+
+    /**
+     * @brief Hash whole genome
+     *
+     * @param genome genome
+     * @return uint64_t hash
+     */
+    uint64_t hash(GenomeView genome) const;
+
+    /**
+     * @brief Update hash after change of one gene
+     *
+     * @param hash hash before change
+     * @param index index of changed gene
+     * @param from previous value of gene
+     * @param to new value of gene
+     * @return uint64_t hash after change
+     */
+    uint64_t update(uint64_t hash, size_t index, uint32_t from, uint32_t to) const;
+
+    /**
+     * @brief Update hash of genome derived from another genome
+     *
+     * Only genes that differ touch the keys.
+     *
+     * @param hash hash of original genome
+     * @param original original genome
+     * @param derived derived genome
+     * @return uint64_t hash of derived genome
+     */
+    uint64_t update(uint64_t hash, GenomeView original, GenomeView derived) const;
+};
+
+/**
+ * @brief Statistics of cache usage
+ *
+ */
+struct CacheStatistics {
+    size_t hits; //!< Lookups that found scores in cache
+    size_t misses; //!< Lookups that had to calculate scores
+    size_t capacity; //!< Maximum number of cached genomes
+};
+
+/**
+ * @brief Bounded cache of scores of genomes
+ *
+ * Direct-mapped by genome hash, newer genome replaces older one in the same slot.
+ * Genome is stored alongside its scores, so a hash collision can never return wrong scores.
+ *
+ * Thread safe, slots are guarded by a fixed set of locks.
+ *
+ */
+class FitnessCache {
+
+    /**
+     * @brief Cached genome and its scores
+     *
+     */
+    struct Slot {
+        uint64_t hash = 0;
+        Genome genome;
+        std::optional<Scores> scores;
+    };
+
+    std::vector<Slot> slots; // Cache slots (size is power of two)
+    std::unique_ptr<std::mutex[]> locks; // Locks of groups of slots
+
+    std::atomic<size_t> hits;
+    std::atomic<size_t> misses;
+
+public:
+
+    FitnessCache() = delete;
+
+    /**
+     * @brief Construct a new Fitness Cache object
+     *
+     * @param capacity maximum number of cached genomes (rounded down to power of two)
+     */
+    FitnessCache(size_t capacity);
+
+    /**
+     * @brief Find scores of genome
+     *
+     * @param genome genome
+     * @param hash hash of genome
+     * @return std::optional<Scores> cached scores, if present
+     */
+    std::optional<Scores> find(GenomeView genome, uint64_t hash);
+
+    /**
+     * @brief Store scores of genome
+     *
+     * @param genome genome
+     * @param hash hash of genome
+     * @param scores scores of genome
+     */
+    void store(GenomeView genome, uint64_t hash, const Scores & scores);
+
+    /**
+     * @brief Get statistics of cache usage
+     *
+     * @return CacheStatistics statistics
+     */
+    CacheStatistics getStatistics() const;
+
+private:
+
+    /**
+     * @brief Lock guarding slot
+     *
+     * @param slot index of slot
+     * @return std::mutex& lock
+     */
+    std::mutex & lockFor(size_t slot) const;
+};
+
+#endif /* FITNESSCACHE_H */
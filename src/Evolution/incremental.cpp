@@ -0,0 +1,148 @@
+#include "incremental.h"
+
+#include <algorithm>
+
+IncrementalScorer::IncrementalScorer(const ProblemModel & problem, const Priorities & p) :
+    evaluator(problem, p),
+    genome(),
+    workspace(),
+    dayScores(),
+    bonuses(0),
+    scratch() { }
+
+void IncrementalScorer::reset(const Genome & g) {
+    genome = g;
+    bonuses = evaluator.fillDays(genome, workspace);
+
+    std::array<size_t, 7> sizes;
+    for (size_t day = 0; day < 7; day++) {
+        sizes[day] = workspace.days[day].size();
+    }
+
+    size_t first = ScoreEvaluator::firstDay(sizes);
+    for (size_t day = 0; day < 7; day++) {
+        dayScores[day] = evaluator.evaluateDay(workspace.days[day], day == first);
+    }
+}
+
+const Genome & IncrementalScorer::getGenome() const {
+    return genome;
+}
+
+Scores IncrementalScorer::getScores() const {
+    return evaluator.composeScores(dayScores, bonuses);
+}
+
+Scores IncrementalScorer::getScoresWith(size_t index, uint32_t value) {
+
+    // Days touched by the change
+    std::array<bool, 7> touched;
+    touched.fill(false);
+    std::array<size_t, 7> sizes;
+    for (size_t day = 0; day < 7; day++) {
+        sizes[day] = workspace.days[day].size();
+    }
+    for (auto & [ day, interval ] : evaluator.intervalsOf(index, genome[index])) {
+        touched[day] = true;
+        sizes[day]--;
+    }
+    for (auto & [ day, interval ] : evaluator.intervalsOf(index, value)) {
+        touched[day] = true;
+        sizes[day]++;
+    }
+
+    // First day is evaluated differently, if it moves both old and new first day change
+    std::array<size_t, 7> currentSizes;
+    for (size_t day = 0; day < 7; day++) {
+        currentSizes[day] = workspace.days[day].size();
+    }
+    size_t oldFirst = ScoreEvaluator::firstDay(currentSizes);
+    size_t newFirst = ScoreEvaluator::firstDay(sizes);
+    if (oldFirst != newFirst) {
+        if (oldFirst < 7) {
+            touched[oldFirst] = true;
+        }
+        if (newFirst < 7) {
+            touched[newFirst] = true;
+        }
+    }
+
+    // Re-evaluate only touched days
+    std::array<DayScores, 7> partial = dayScores;
+    for (size_t day = 0; day < 7; day++) {
+        if (!touched[day]) {
+            continue;
+        }
+
+        changedDay(day, index, value, scratch);
+        partial[day] = evaluator.evaluateDay(scratch, day == newFirst);
+    }
+
+    return evaluator.composeScores(partial, bonuses - evaluator.bonusOf(index, genome[index]) + evaluator.bonusOf(index, value));
+}
+
+void IncrementalScorer::change(size_t index, uint32_t value) {
+
+    std::array<size_t, 7> oldSizes;
+    for (size_t day = 0; day < 7; day++) {
+        oldSizes[day] = workspace.days[day].size();
+    }
+    size_t oldFirst = ScoreEvaluator::firstDay(oldSizes);
+
+    // Replace intervals in touched days
+    std::array<bool, 7> touched;
+    touched.fill(false);
+    for (auto & [ day, interval ] : evaluator.intervalsOf(index, genome[index])) {
+        touched[day] = true;
+    }
+    for (auto & [ day, interval ] : evaluator.intervalsOf(index, value)) {
+        touched[day] = true;
+    }
+    for (size_t day = 0; day < 7; day++) {
+        if (touched[day]) {
+            changedDay(day, index, value, scratch);
+            std::swap(workspace.days[day], scratch);
+        }
+    }
+
+    bonuses += evaluator.bonusOf(index, value) - evaluator.bonusOf(index, genome[index]);
+    genome[index] = value;
+
+    std::array<size_t, 7> newSizes;
+    for (size_t day = 0; day < 7; day++) {
+        newSizes[day] = workspace.days[day].size();
+    }
+    size_t newFirst = ScoreEvaluator::firstDay(newSizes);
+    if (oldFirst != newFirst) {
+        if (oldFirst < 7) {
+            touched[oldFirst] = true;
+        }
+        if (newFirst < 7) {
+            touched[newFirst] = true;
+        }
+    }
+
+    for (size_t day = 0; day < 7; day++) {
+        if (touched[day]) {
+            dayScores[day] = evaluator.evaluateDay(workspace.days[day], day == newFirst);
+        }
+    }
+}
+
+void IncrementalScorer::changedDay(size_t day, size_t index, uint32_t value, std::vector<DayInterval> & result) const {
+    result.clear();
+
+    // Keep intervals of other genes
+    for (auto & interval : workspace.days[day]) {
+        if (interval.gene != index) {
+            result.push_back(interval);
+        }
+    }
+
+    // Insert intervals of new entry in sorted order
+    for (auto & [ entryDay, interval ] : evaluator.intervalsOf(index, value)) {
+        if (entryDay == day) {
+            result.insert(std::upper_bound(result.begin(), result.end(), interval), interval);
+        }
+    }
+}
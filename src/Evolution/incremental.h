@@ -0,0 +1,117 @@
+/**
+ * @file incremental.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Incremental scoring of genome with changes of single genes
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "Data/priorities.h"
+#include "Evolution/crossovers.h"
+#include "Evolution/problem.h"
+#include "Evolution/scores.h"
+#include "Evolution/evaluator.h"
+
+#include <vector>
+#include <array>
+
+/**
+ * @brief Incremental scorer of one genome
+ *
+ * Keeps intervals of selected entries in sorted per-day buckets together with
+ * partial scores of each day (calculated by ScoreEvaluator). Scores of a genome
+ * with one gene changed are calculated by re-evaluating only days touched
+ * by the old and new entry, so the cost is proportional to number of intervals in those days.
+ *
+ * Scores are identical to scores calculated by Scores::calculateScore.
+ *
+ * Evolution uses it only for local search, offsprings differ from their parent
+ * by crossover in many genes, so they are scored whole (see ScoreEvaluator).
+ *
+ */
+class IncrementalScorer {
+
+    using DayInterval = ScoreEvaluator::DayInterval;
+    using DayScores = ScoreEvaluator::DayScores;
+
+    ScoreEvaluator evaluator; // Calculation of partial scores of days
+
+    Genome genome; // Current genome
+    ScoreEvaluator::Workspace workspace; // Sorted intervals of current genome in each day (in its days)
+    std::array<DayScores, 7> dayScores; // Partial scores of each day
+    double bonuses; // Sum of bonuses of current genome
+
+    std::vector<DayInterval> scratch; // Reused buffer for evaluating changed day
+
+public:
+
+    IncrementalScorer() = delete;
+
+    /**
+     * @brief Construct a new Incremental Scorer object
+     *
+     * @param problem flat model of schedules of genome
+     * @param p priorities for timetable generation
+     */
+    IncrementalScorer(const ProblemModel & problem, const Priorities & p);
+
+    /**
+     * @brief Set genome to be scored (full evaluation)
+     *
+     * @param g genome
+     */
+    void reset(const Genome & g);
+
+    /**
+     * @brief Get current genome
+     *
+     * @return const Genome& genome
+     */
+    const Genome & getGenome() const;
+
+    /**
+     * @brief Get scores of current genome
+     *
+     * @return Scores scores
+     */
+    Scores getScores() const;
+
+    /**
+     * @brief Get scores of current genome with one gene changed
+     *
+     * The current genome is not changed.
+     *
+     * @param index index of gene
+     * @param value new value of gene
+     * @return Scores scores of changed genome
+     */
+    Scores getScoresWith(size_t index, uint32_t value);
+
+    /**
+     * @brief Change one gene of current genome
+     *
+     * @param index index of gene
+     * @param value new value of gene
+     */
+    void change(size_t index, uint32_t value);
+
+private:
+
+    /**
+     * @brief Intervals of a day with one gene changed
+     *
+     * @param day index of day
+     * @param index index of gene
+     * @param value new value of gene
+     * @param[out] result sorted intervals
+     */
+    void changedDay(size_t day, size_t index, uint32_t value, std::vector<DayInterval> & result) const;
+};
+
+#endif /* INCREMENTAL_H */
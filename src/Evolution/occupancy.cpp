@@ -0,0 +1,160 @@
+#include "occupancy.h"
+
+#include "Utility/cpu.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Number of words processed at once by vector operations
+#define OCCUPANCY_WORDS_IN_VECTOR 4
+
+#if defined(__x86_64__)
+
+// AVX2 variants of bitmap operations, used only if the processor supports them
+
+__attribute__((target("avx2")))
+static bool intersectsAvx2(const uint64_t * lhs, const uint64_t * rhs, size_t words) {
+    for (size_t i = 0; i < words; i += OCCUPANCY_WORDS_IN_VECTOR) {
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+        if (!_mm256_testz_si256(l, r)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+__attribute__((target("avx2")))
+static void mergeAvx2(uint64_t * target, const uint64_t * source, size_t words) {
+    for (size_t i = 0; i < words; i += OCCUPANCY_WORDS_IN_VECTOR) {
+        __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(target + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + i), _mm256_or_si256(t, s));
+    }
+}
+
+#endif
+
+OccupancyModel::OccupancyModel(const ProblemModel & problem) :
+    boundaries(),
+    slotCount(0),
+    wordCount(0),
+    offsets(),
+    bitmaps(),
+    dayMasks() {
+
+    // Compress all start and end times
+    for (size_t entry = 0; entry < problem.getEntryCount(); entry++) {
+        for (auto & timeslot : problem.timeslots(entry)) {
+            boundaries.push_back(timeslot.startTime.valueInMinutes());
+            boundaries.push_back(timeslot.endTime.valueInMinutes());
+        }
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    // Two planes of 7 days, rounded up to whole vectors
+    slotCount = boundaries.empty() ? 0 : boundaries.size() - 1;
+    size_t bits = 2 * 7 * slotCount;
+    wordCount = (bits + 63) / 64;
+    wordCount = (wordCount + OCCUPANCY_WORDS_IN_VECTOR - 1) / OCCUPANCY_WORDS_IN_VECTOR * OCCUPANCY_WORDS_IN_VECTOR;
+
+    // Create bitmaps of all entries
+    for (size_t gene = 0; gene < problem.getGeneCount(); gene++) {
+        offsets.push_back(problem.entryOffset(gene));
+    }
+    bitmaps.assign(problem.getEntryCount() * wordCount, 0);
+
+    for (size_t entry = 0; entry < problem.getEntryCount(); entry++) {
+        if (problem.isIgnored(problem.geneOf(entry))) {
+            continue;
+        }
+
+        for (auto & timeslot : problem.timeslots(entry)) {
+            addInterval(timeslot, bitmaps.data() + entry * wordCount);
+        }
+    }
+
+    // Masks of days, for finding span of days
+    dayMasks.assign(7 * wordCount, 0);
+    for (size_t day = 0; day < 7; day++) {
+        for (size_t plane = 0; plane < 2; plane++) {
+            for (size_t slot = 0; slot < slotCount; slot++) {
+                size_t bit = (plane * 7 + day) * slotCount + slot;
+                dayMasks[day * wordCount + bit / 64] |= uint64_t(1) << (bit % 64);
+            }
+        }
+    }
+}
+
+size_t OccupancyModel::getWordCount() const {
+    return wordCount;
+}
+
+const uint64_t * OccupancyModel::bitmap(size_t gene, uint32_t value) const {
+    return bitmaps.data() + (offsets[gene] + value) * wordCount;
+}
+
+void OccupancyModel::addInterval(const TimeInterval & interval, uint64_t * result) const {
+    size_t first = std::lower_bound(boundaries.begin(), boundaries.end(), interval.startTime.valueInMinutes()) - boundaries.begin();
+    size_t last = std::lower_bound(boundaries.begin(), boundaries.end(), interval.endTime.valueInMinutes()) - boundaries.begin();
+    size_t day = static_cast<size_t>(interval.day);
+
+    for (size_t plane = 0; plane < 2; plane++) {
+        // Even plane is 0, odd plane is 1, both parities occupy both
+        if ((interval.parity == TimeInterval::Parity::Even && plane == 1)
+            || (interval.parity == TimeInterval::Parity::Odd && plane == 0)) {
+            continue;
+        }
+
+        for (size_t slot = first; slot < last; slot++) {
+            size_t bit = (plane * 7 + day) * slotCount + slot;
+            result[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+    }
+}
+
+size_t OccupancyModel::daySpan(const uint64_t * bitmap) const {
+    size_t first = 7;
+    size_t last = 0;
+
+    for (size_t day = 0; day < 7; day++) {
+        if (intersects(bitmap, dayMasks.data() + day * wordCount, wordCount)) {
+            first = std::min(first, day);
+            last = day;
+        }
+    }
+
+    return (first < 7) ? last - first : 0;
+}
+
+bool OccupancyModel::intersects(const uint64_t * lhs, const uint64_t * rhs, size_t words) {
+#if defined(__x86_64__)
+    if (hasAvx2()) {
+        return intersectsAvx2(lhs, rhs, words);
+    }
+#endif
+
+    for (size_t i = 0; i < words; i++) {
+        if ((lhs[i] & rhs[i]) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OccupancyModel::merge(uint64_t * target, const uint64_t * source, size_t words) {
+#if defined(__x86_64__)
+    if (hasAvx2()) {
+        mergeAvx2(target, source, words);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < words; i++) {
+        target[i] |= source[i];
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * @file occupancy.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Week occupancy bitmaps of entries
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include "Evolution/problem.h"
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Week occupancy bitmaps of all entries
+ *
+ * All distinct start and end times are compressed to a sorted list of boundaries,
+ * time between two neighbouring boundaries is one slot. Each entry is a bitmap
+ * of 7 days times slots, with separate planes for even and odd weeks
+ * (interval with both parities occupies both planes).
+ *
+ * Timeslots can only collide when their bitmaps share a bit, so operations
+ * over bitmaps (and, or) skip comparing of timeslots that can not collide.
+ * Entries of ignored schedules have empty bitmaps.
+ *
+ * Scores of genomes do not use bitmaps: collisions count pairs of overlapping timeslots,
+ * gaps and runs compare neighbours of sorted intervals, neither can be read from
+ * a union of occupied slots when intervals overlap.
+ *
+ * Operations use AVX2 when the processor supports it.
+ *
+ */
+class OccupancyModel {
+
+    std::vector<uint32_t> boundaries; // Sorted distinct start and end times in minutes
+    size_t slotCount; // Slots in one day
+    size_t wordCount; // Words of one bitmap (multiple of 4)
+
+    std::vector<size_t> offsets; // Index of first entry of each gene
+    std::vector<uint64_t> bitmaps; // Bitmaps of all entries
+
+    std::vector<uint64_t> dayMasks; // Bitmap of each day (both planes)
+
+public:
+
+    OccupancyModel() = delete;
+
+    /**
+     * @brief Construct a new Occupancy Model object
+     *
+     * @param problem flat model of schedules of genome
+     */
+    OccupancyModel(const ProblemModel & problem);
+
+    /**
+     * @brief Get number of words of one bitmap
+     *
+     * @return size_t number of words
+     */
+    size_t getWordCount() const;
+
+    /**
+     * @brief Get bitmap of entry
+     *
+     * @param gene index of gene
+     * @param value index of entry in its schedule
+     * @return const uint64_t* bitmap
+     */
+    const uint64_t * bitmap(size_t gene, uint32_t value) const;
+
+    /**
+     * @brief Create bitmap of single timeslot
+     *
+     * Timeslot must begin and end on times of entries the model was built from.
+     *
+     * @param interval timeslot
+     * @param[out] result bitmap, bits of timeslot are added to it
+     */
+    void addInterval(const TimeInterval & interval, uint64_t * result) const;
+
+    /**
+     * @brief Calculate span of days of bitmap
+     *
+     * Matches CoherentInWeekScore (for timeslots that are not empty),
+     * number of days between first and last occupied day.
+     *
+     * @param bitmap bitmap
+     * @return size_t span of days (0 if bitmap is empty)
+     */
+    size_t daySpan(const uint64_t * bitmap) const;
+
+    /**
+     * @brief Check if bitmaps share any bit
+     *
+     * @param lhs bitmap
+     * @param rhs bitmap
+     * @param words number of words (multiple of 4)
+     * @return true bitmaps intersect
+     */
+    static bool intersects(const uint64_t * lhs, const uint64_t * rhs, size_t words);
+
+    /**
+     * @brief Add bits of bitmap to another bitmap
+     *
+     * @param target bitmap to be changed
+     * @param source bitmap
+     * @param words number of words (multiple of 4)
+     */
+    static void merge(uint64_t * target, const uint64_t * source, size_t words);
+};
+
+#endif /* OCCUPANCY_H */
@@ -0,0 +1,173 @@
+#include "population.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+// Access to genes stored with narrow type, bytes are copied so rows need no alignment
+
+template<typename Gene>
+static uint32_t loadGene(const uint8_t * position) {
+    Gene gene;
+    std::memcpy(&gene, position, sizeof(Gene));
+    return gene;
+}
+
+template<typename Gene>
+static void storeGene(uint8_t * position, uint32_t value) {
+    Gene gene = static_cast<Gene>(value);
+    std::memcpy(position, &gene, sizeof(Gene));
+}
+
+template<typename Gene>
+static void widen(const uint8_t * row, GenomeBuffer genome) {
+    for (size_t i = 0; i < genome.size(); i++) {
+        genome[i] = loadGene<Gene>(row + i * sizeof(Gene));
+    }
+}
+
+template<typename Gene>
+static void narrow(GenomeView genome, uint8_t * row) {
+    for (size_t i = 0; i < genome.size(); i++) {
+        storeGene<Gene>(row + i * sizeof(Gene), genome[i]);
+    }
+}
+
+GeneMatrix::GeneMatrix(size_t rows, size_t genes, size_t w) :
+    rowCount(rows),
+    geneCount(genes),
+    width(w),
+    data() {
+
+    if (width != sizeof(uint8_t) && width != sizeof(uint16_t) && width != sizeof(uint32_t)) {
+        throw std::invalid_argument("Unsupported width of gene.");
+    }
+
+    data.assign(rowCount * geneCount * width, 0);
+}
+
+size_t GeneMatrix::widthFor(size_t valueCount) {
+    if (valueCount <= size_t(std::numeric_limits<uint8_t>::max()) + 1) {
+        return sizeof(uint8_t);
+    }
+    if (valueCount <= size_t(std::numeric_limits<uint16_t>::max()) + 1) {
+        return sizeof(uint16_t);
+    }
+
+    return sizeof(uint32_t);
+}
+
+size_t GeneMatrix::getRowCount() const {
+    return rowCount;
+}
+
+size_t GeneMatrix::getGeneCount() const {
+    return geneCount;
+}
+
+size_t GeneMatrix::getWidth() const {
+    return width;
+}
+
+uint32_t GeneMatrix::get(size_t row, size_t gene) const {
+    const uint8_t * position = data.data() + (row * geneCount + gene) * width;
+    switch (width) {
+        case sizeof(uint8_t):
+            return loadGene<uint8_t>(position);
+        case sizeof(uint16_t):
+            return loadGene<uint16_t>(position);
+        default:
+            return loadGene<uint32_t>(position);
+    }
+}
+
+void GeneMatrix::set(size_t row, size_t gene, uint32_t value) {
+    uint8_t * position = data.data() + (row * geneCount + gene) * width;
+    switch (width) {
+        case sizeof(uint8_t):
+            storeGene<uint8_t>(position, value);
+            break;
+        case sizeof(uint16_t):
+            storeGene<uint16_t>(position, value);
+            break;
+        default:
+            storeGene<uint32_t>(position, value);
+            break;
+    }
+}
+
+void GeneMatrix::load(size_t row, GenomeBuffer genome) const {
+    const uint8_t * position = data.data() + row * geneCount * width;
+    switch (width) {
+        case sizeof(uint8_t):
+            widen<uint8_t>(position, genome);
+            break;
+        case sizeof(uint16_t):
+            widen<uint16_t>(position, genome);
+            break;
+        default:
+            widen<uint32_t>(position, genome);
+            break;
+    }
+}
+
+void GeneMatrix::store(size_t row, GenomeView genome) {
+    uint8_t * position = data.data() + row * geneCount * width;
+    switch (width) {
+        case sizeof(uint8_t):
+            narrow<uint8_t>(genome, position);
+            break;
+        case sizeof(uint16_t):
+            narrow<uint16_t>(genome, position);
+            break;
+        default:
+            narrow<uint32_t>(genome, position);
+            break;
+    }
+}
+
+void GeneMatrix::copyRow(size_t row, const GeneMatrix & source, size_t sourceRow) {
+    size_t rowBytes = geneCount * width;
+    std::memcpy(data.data() + row * rowBytes, source.data.data() + sourceRow * rowBytes, rowBytes);
+}
+
+Population::Population(size_t capacity, size_t genomeSize, size_t width, CriteriaMask criteria) :
+    genes(capacity, genomeSize, width),
+    hashes(capacity, 0),
+    scores(capacity, Scores(criteria)),
+    fitness(capacity, 0),
+    orders(capacity, 0),
+    ranking() {
+
+    ranking.reserve(capacity);
+}
+
+size_t Population::getCapacity() const {
+    return genes.getRowCount();
+}
+
+size_t Population::size() const {
+    return ranking.size();
+}
+
+size_t Population::rowOf(size_t rank) const {
+    return ranking[rank];
+}
+
+void Population::rank(size_t count) {
+    ranking.resize(count);
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::sort(ranking.begin(), ranking.end(), [ & ] (uint32_t lhs, uint32_t rhs) {
+        return isBetter(lhs, rhs);
+        });
+}
+
+bool Population::isBetter(size_t lhs, size_t rhs) const {
+    if (fitness[lhs] != fitness[rhs]) {
+        return fitness[lhs] > fitness[rhs];
+    }
+
+    return orders[lhs] < orders[rhs];
+}
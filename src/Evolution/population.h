@@ -0,0 +1,191 @@
+/**
+ * @file population.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Flat storage of genomes of a generation
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include "Evolution/crossovers.h"
+#include "Evolution/scores.h"
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Genes of many genomes in one contiguous row-major matrix
+ *
+ * Each row is one genome. Genes are stored in the narrowest unsigned type
+ * (1, 2 or 4 bytes) able to hold index of an entry of the largest schedule.
+ *
+ */
+class GeneMatrix {
+
+    size_t rowCount; // Number of genomes
+    size_t geneCount; // Number of genes of each genome
+    size_t width; // Bytes of one gene
+    std::vector<uint8_t> data; // Genes of all rows
+
+public:
+
+    GeneMatrix() = delete;
+
+    /**
+     * @brief Construct a new Gene Matrix object, all genes are zero
+     *
+     * @throws std::invalid_argument if width is not 1, 2 or 4
+     *
+     * @param rows number of genomes
+     * @param genes number of genes of each genome
+     * @param w bytes of one gene
+     */
+    GeneMatrix(size_t rows, size_t genes, size_t w);
+
+    /**
+     * @brief Narrowest width of gene able to hold all values
+     *
+     * @param valueCount largest number of values of a gene
+     * @return size_t bytes of one gene (1, 2 or 4)
+     */
+    static size_t widthFor(size_t valueCount);
+
+    /**
+     * @brief Get number of genomes
+     *
+     * @return size_t number of rows
+     */
+    size_t getRowCount() const;
+
+    /**
+     * @brief Get number of genes of each genome
+     *
+     * @return size_t number of genes
+     */
+    size_t getGeneCount() const;
+
+    /**
+     * @brief Get bytes of one gene
+     *
+     * @return size_t width of gene
+     */
+    size_t getWidth() const;
+
+    /**
+     * @brief Get gene
+     *
+     * @param row index of genome
+     * @param gene index of gene
+     * @return uint32_t value of gene
+     */
+    uint32_t get(size_t row, size_t gene) const;
+
+    /**
+     * @brief Set gene
+     *
+     * @param row index of genome
+     * @param gene index of gene
+     * @param value value of gene
+     */
+    void set(size_t row, size_t gene, uint32_t value);
+
+    /**
+     * @brief Widen genes of a row into genome
+     *
+     * @param row index of genome
+     * @param[out] genome storage for genome with number of genes of matrix
+     */
+    void load(size_t row, GenomeBuffer genome) const;
+
+    /**
+     * @brief Narrow genome into a row
+     *
+     * @param row index of genome
+     * @param genome genome with number of genes of matrix
+     */
+    void store(size_t row, GenomeView genome);
+
+    /**
+     * @brief Copy row of other matrix of same shape into a row
+     *
+     * @param row index of target genome
+     * @param source matrix with same number of genes and width
+     * @param sourceRow index of genome in source
+     */
+    void copyRow(size_t row, const GeneMatrix & source, size_t sourceRow);
+};
+
+/**
+ * @brief Genomes of a generation with their hashes, scores and fitness
+ *
+ * All data are stored in rows allocated once for capacity of the generation.
+ * Genomes are never moved between rows, their order by fitness is kept
+ * as a permutation of rows.
+ *
+ */
+struct Population {
+    GeneMatrix genes; //!< Genes, one row for each genome
+    std::vector<uint64_t> hashes; //!< Hash of genome in each row
+    std::vector<Scores> scores; //!< Scores of genome in each row
+    std::vector<double> fitness; //!< Fitness of genome in each row
+    std::vector<size_t> orders; //!< Order in which genome in each row was offered, breaks ties in fitness (lower is preferred)
+    std::vector<uint32_t> ranking; //!< Occupied rows sorted from the best genome
+
+    Population() = delete;
+
+    /**
+     * @brief Construct a new Population object with no ranked genomes
+     *
+     * @param capacity number of rows
+     * @param genomeSize number of genes of each genome
+     * @param width bytes of one gene
+     * @param criteria criteria enabled in scores
+     */
+    Population(size_t capacity, size_t genomeSize, size_t width, CriteriaMask criteria);
+
+    /**
+     * @brief Get number of rows
+     *
+     * @return size_t capacity
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief Get number of ranked genomes
+     *
+     * @return size_t size of generation
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get row of genome with given rank
+     *
+     * @param rank index of genome sorted by fitness (zero is the best)
+     * @return size_t index of row
+     */
+    size_t rowOf(size_t rank) const;
+
+    /**
+     * @brief Rank first rows by fitness, then by order
+     *
+     * @param count number of occupied rows
+     */
+    void rank(size_t count);
+
+    /**
+     * @brief Compare genomes by fitness, then by order
+     *
+     * @param lhs index of row
+     * @param rhs index of row
+     * @return true genome in lhs is better than genome in rhs
+     * @return false genome in lhs is not better than genome in rhs
+     */
+    bool isBetter(size_t lhs, size_t rhs) const;
+};
+
+#endif /* POPULATION_H */
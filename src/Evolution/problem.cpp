@@ -0,0 +1,80 @@
+#include "problem.h"
+
+ProblemModel::ProblemModel(const std::vector<std::shared_ptr<Schedule>> & schedules) :
+    entryOffsets(),
+    entryGenes(),
+    ignored(),
+    bonuses(),
+    timeslotOffsets(),
+    timeslotArray() {
+
+    for (size_t gene = 0; gene < schedules.size(); gene++) {
+        const Schedule & schedule = *schedules[gene];
+        entryOffsets.push_back(entryGenes.size());
+        ignored.push_back(schedule.ignored);
+
+        for (auto & entry : schedule.entriesPtrs) {
+            entryGenes.push_back(static_cast<uint32_t>(gene));
+            bonuses.push_back(entry->getBonus());
+
+            timeslotOffsets.push_back(timeslotArray.size());
+            timeslotArray.insert(timeslotArray.end(), entry->timeslots.begin(), entry->timeslots.end());
+        }
+    }
+    entryOffsets.push_back(entryGenes.size());
+    timeslotOffsets.push_back(timeslotArray.size());
+}
+
+size_t ProblemModel::getGeneCount() const {
+    return ignored.size();
+}
+
+size_t ProblemModel::getEntryCount() const {
+    return entryGenes.size();
+}
+
+uint32_t ProblemModel::valueCount(size_t gene) const {
+    return static_cast<uint32_t>(entryOffsets[gene + 1] - entryOffsets[gene]);
+}
+
+size_t ProblemModel::entryOffset(size_t gene) const {
+    return entryOffsets[gene];
+}
+
+size_t ProblemModel::entryIndex(size_t gene, uint32_t value) const {
+    return entryOffsets[gene] + value;
+}
+
+size_t ProblemModel::geneOf(size_t entry) const {
+    return entryGenes[entry];
+}
+
+bool ProblemModel::isIgnored(size_t gene) const {
+    return ignored[gene] != 0;
+}
+
+double ProblemModel::bonus(size_t entry) const {
+    return bonuses[entry];
+}
+
+std::span<const TimeInterval> ProblemModel::timeslots(size_t entry) const {
+    return std::span<const TimeInterval>(timeslotArray.data() + timeslotOffsets[entry],
+        timeslotOffsets[entry + 1] - timeslotOffsets[entry]);
+}
+
+uint32_t ProblemModel::collisions(size_t lhs, size_t rhs) const {
+    std::span<const TimeInterval> lTimeslots = timeslots(lhs);
+    std::span<const TimeInterval> rTimeslots = timeslots(rhs);
+
+    uint32_t count = 0;
+    for (size_t i = 0; i < lTimeslots.size(); i++) {
+        for (size_t j = (lhs == rhs ? i + 1 : 0); j < rTimeslots.size(); j++) {
+            if (lTimeslots[i].collidesWith(rTimeslots[j])) {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
@@ -0,0 +1,134 @@
+/**
+ * @file problem.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Compiled, flat model of a timetabling problem
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef PROBLEM_H
+#define PROBLEM_H
+
+#include "Data/subjects.h"
+#include "Data/timeinterval.h"
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <cstdint>
+
+/**
+ * @brief Immutable flat model of schedules of a genome
+ *
+ * Schedules (genes) and their entries get dense indices, entries of gene `g` are
+ * `entryOffset(g)` to `entryOffset(g + 1) - 1`. Timeslots of all entries are stored
+ * in one contiguous array, ignored flags and bonuses in arrays indexed by gene and entry,
+ * so evolution does not touch shared pointers of the Semester.
+ *
+ */
+class ProblemModel {
+
+    std::vector<size_t> entryOffsets; // Index of first entry of each gene (one more item at end)
+    std::vector<uint32_t> entryGenes; // Gene of each entry
+    std::vector<uint8_t> ignored; // Whether each gene is ignored
+    std::vector<double> bonuses; // Bonus of each entry
+
+    std::vector<size_t> timeslotOffsets; // Index of first timeslot of each entry (one more item at end)
+    std::vector<TimeInterval> timeslotArray; // Timeslots of all entries
+
+public:
+
+    ProblemModel() = delete;
+
+    /**
+     * @brief Compile schedules into a model
+     *
+     * @param schedules schedules of genome, index in vector matches index in genome
+     */
+    ProblemModel(const std::vector<std::shared_ptr<Schedule>> & schedules);
+
+    /**
+     * @brief Get number of genes
+     *
+     * @return size_t number of genes
+     */
+    size_t getGeneCount() const;
+
+    /**
+     * @brief Get number of entries of all genes
+     *
+     * @return size_t number of entries
+     */
+    size_t getEntryCount() const;
+
+    /**
+     * @brief Get number of possible values of gene
+     *
+     * @param gene index of gene
+     * @return uint32_t number of entries of its schedule
+     */
+    uint32_t valueCount(size_t gene) const;
+
+    /**
+     * @brief Get dense index of first entry of gene
+     *
+     * @param gene index of gene (genome size for index after the last entry)
+     * @return size_t index of entry
+     */
+    size_t entryOffset(size_t gene) const;
+
+    /**
+     * @brief Get dense index of entry
+     *
+     * @param gene index of gene
+     * @param value index of entry in its schedule
+     * @return size_t index of entry
+     */
+    size_t entryIndex(size_t gene, uint32_t value) const;
+
+    /**
+     * @brief Get gene of entry
+     *
+     * @param entry index of entry
+     * @return size_t index of gene
+     */
+    size_t geneOf(size_t entry) const;
+
+    /**
+     * @brief Check if gene is ignored during generation
+     *
+     * @param gene index of gene
+     * @return true schedule is ignored
+     */
+    bool isIgnored(size_t gene) const;
+
+    /**
+     * @brief Get bonus of entry
+     *
+     * @param entry index of entry
+     * @return double bonus
+     */
+    double bonus(size_t entry) const;
+
+    /**
+     * @brief Get timeslots of entry
+     *
+     * @param entry index of entry
+     * @return std::span<const TimeInterval> timeslots
+     */
+    std::span<const TimeInterval> timeslots(size_t entry) const;
+
+    /**
+     * @brief Count collisions of two entries (or of entry with itself)
+     *
+     * @param lhs index of entry
+     * @param rhs index of entry
+     * @return uint32_t number of colliding pairs of timeslots
+     */
+    uint32_t collisions(size_t lhs, size_t rhs) const;
+};
+
+#endif /* PROBLEM_H */
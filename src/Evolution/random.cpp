@@ -0,0 +1,97 @@
+#include "random.h"
+
+namespace {
+
+    /**
+     * @brief SplitMix64 step, used for seeding and mixing counters
+     *
+     * @param x[inout] state of SplitMix64
+     * @return uint64_t mixed value
+     */
+    inline uint64_t splitMix(uint64_t & x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    __extension__ using Wide = unsigned __int128; // 128-bit product of 64-bit numbers (GCC and Clang)
+
+    inline uint64_t rotateLeft(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+}
+
+Random::Random(uint64_t seed) : state() {
+    seedState(seed);
+}
+
+Random::Random(uint64_t seed, uint64_t stream, uint64_t substream) : state() {
+    // Mix counters into the seed, each through its own SplitMix64 step
+    uint64_t mixer = seed;
+    uint64_t streamMixer = stream;
+    uint64_t substreamMixer = ~substream;
+    seedState(splitMix(mixer) ^ rotateLeft(splitMix(streamMixer), 21) ^ rotateLeft(splitMix(substreamMixer), 43));
+}
+
+void Random::seedState(uint64_t seed) {
+    for (auto & value : state) {
+        value = splitMix(seed);
+    }
+}
+
+uint64_t Random::next() {
+    uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+
+    state[2] ^= t;
+    state[3] = rotateLeft(state[3], 45);
+
+    return result;
+}
+
+uint64_t Random::below(uint64_t bound) {
+    // Lemire's multiply-shift, rejection only on the small biased part
+    if (bound <= std::numeric_limits<uint32_t>::max()) {
+        uint32_t narrowBound = static_cast<uint32_t>(bound);
+        uint64_t product = (next() >> 32) * narrowBound;
+        uint32_t low = static_cast<uint32_t>(product);
+
+        if (low < narrowBound) {
+            uint32_t threshold = (0u - narrowBound) % narrowBound;
+            while (low < threshold) {
+                product = (next() >> 32) * narrowBound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+
+        return product >> 32;
+    }
+
+    // Same with 128-bit product for bounds over 32 bits
+    Wide product = static_cast<Wide>(next()) * bound;
+    uint64_t low = static_cast<uint64_t>(product);
+
+    if (low < bound) {
+        uint64_t threshold = (0 - bound) % bound;
+        while (low < threshold) {
+            product = static_cast<Wide>(next()) * bound;
+            low = static_cast<uint64_t>(product);
+        }
+    }
+
+    return static_cast<uint64_t>(product >> 64);
+}
+
+double Random::uniform() {
+    return (next() >> 11) * 0x1.0p-53;
+}
+
+uint64_t Random::operator()() {
+    return next();
+}
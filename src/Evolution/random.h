@@ -0,0 +1,102 @@
+/**
+ * @file random.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Seedable random number generator for genetic algorithm
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <limits>
+
+/**
+ * @brief Seedable pseudo-random number generator (xoshiro256**)
+ *
+ * Every generator is created from a master seed and optionally from a pair of counters
+ * (for example generation and block of offsprings). Generators created from the same
+ * seed and different counters produce independent streams, so a parallel computation
+ * draws the same numbers no matter which thread handles which counters.
+ *
+ * Satisfies UniformRandomBitGenerator, so it can be used with standard distributions.
+ *
+ */
+class Random {
+
+    std::array<uint64_t, 4> state; // Generator state
+
+public:
+
+    using result_type = uint64_t;
+
+    Random() = delete;
+
+    /**
+     * @brief Construct a new Random object
+     *
+     * @param seed master seed
+     */
+    Random(uint64_t seed);
+
+    /**
+     * @brief Construct a new Random object for independent stream
+     *
+     * @param seed master seed
+     * @param stream first counter identifying the stream (e.g. generation)
+     * @param substream second counter identifying the stream (e.g. block of work)
+     */
+    Random(uint64_t seed, uint64_t stream, uint64_t substream);
+
+    /**
+     * @brief Next random 64-bit number
+     *
+     * @return uint64_t random number
+     */
+    uint64_t next();
+
+    /**
+     * @brief Random number
+     *
+     * In range [0, bound), using multiply-shift (without division in the common case).
+     * Bounds that fit in 32 bits use 32 random bits, larger bounds use all 64.
+     *
+     * @param bound upper limit (if zero, zero is returned)
+     * @return uint64_t random number
+     */
+    uint64_t below(uint64_t bound);
+
+    /**
+     * @brief Random real number in range [0, 1)
+     *
+     * @return double random number with 53 random bits
+     */
+    double uniform();
+
+    uint64_t operator()();
+
+    static constexpr uint64_t min() {
+        return std::numeric_limits<uint64_t>::min();
+    }
+
+    static constexpr uint64_t max() {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+private:
+
+    /**
+     * @brief Fill state from seed using SplitMix64
+     *
+     * @param seed value to fill the state from
+     */
+    void seedState(uint64_t seed);
+};
+
+#endif /* RANDOM_H */
@@ -1,81 +1,110 @@
 #include "scores.h"
 
-Scores::Scores(const Priorities & p) : priorities(p), scores() {
-
-    scores.emplace("collisions", new CollisionsScore());
-
-    scores.emplace("bonuses", new BonusesScore());
+#include <array>
+#include <limits>
+
+/**
+ * @brief Bit of criterion in set of criteria
+ *
+ * @param c criterion
+ * @return CriteriaMask bit
+ */
+static CriteriaMask criterionBit(Criterion c) {
+    return CriteriaMask(1) << static_cast<size_t>(c);
+}
 
-    if (p.keepCoherentInDay) {
-        scores.emplace("coherentInDay", new CoherentInDayScore());
-    }
+Scores::Scores(const Priorities & p) : Scores(enabledCriteria(p)) { }
 
-    if (p.keepCoherentInWeek) {
-        scores.emplace("coherentInWeek", new CoherentInWeekScore());
-    }
-
-    if (p.penaliseAfterHour != 0 || p.penaliseBeforeHour != 0) {
-        scores.emplace("wrongStartTime", new WrongStartTimesScore());
-    }
+Scores::Scores(CriteriaMask e) : values(), enabled(e) {
+    values.fill(0);
+}
 
-    if (p.penaliseManyConsecutiveHours != 0) {
-        scores.emplace("manyConsecutiveHours", new ManyConsecutiveHoursScore());
-    }
+double & Scores::operator[](Criterion c) {
+    return values[static_cast<size_t>(c)];
 }
 
-Scores::~Scores() {
-    for (auto & score : scores) {
-        score.second.reset();
-    }
+double Scores::operator[](Criterion c) const {
+    return values[static_cast<size_t>(c)];
 }
 
-Scores::Scores(const Scores & s) : priorities(s.priorities), scores() {
-    for (auto & score : s.scores) {
-        scores.emplace(score.first, score.second->clone());
-    }
+bool Scores::isEnabled(Criterion c) const {
+    return (enabled & criterionBit(c)) != 0;
 }
 
-Scores & Scores::operator=(const Scores & s) {
-    priorities = s.priorities;
+Scores & Scores::setToMinValuesFrom(const Scores & s) {
 
-    for (auto & score : scores) {
-        score.second.reset();
+    for (size_t i = 0; i < CRITERIA_COUNT; i++) {
+        values[i] = std::min(values[i], s.values[i]);
     }
 
-    scores.clear();
+    return *this;
+}
+
+Scores & Scores::setToMaxValuesFrom(const Scores & s) {
 
-    for (auto & score : s.scores) {
-        scores.emplace(score.first, score.second->clone());
+    for (size_t i = 0; i < CRITERIA_COUNT; i++) {
+        values[i] = std::max(values[i], s.values[i]);
     }
 
     return *this;
 }
 
-Scores & Scores::setToMinValuesFrom(const Scores & s) {
+/**
+ * @brief Set value of enabled criterion using its reference calculation
+ *
+ * @tparam ScoreType calculation of criterion
+ * @tparam Function function setting the value of calculation
+ * @param scores scores to set
+ * @param c criterion
+ * @param function function to be called with calculation
+ */
+template<typename ScoreType, typename Function>
+static void setCriterion(Scores & scores, Criterion c, Function function) {
+    if (!scores.isEnabled(c)) {
+        return;
+    }
+
+    ScoreType score;
+    function(score);
+    scores[c] = score.value;
+}
 
-    for (auto & score : scores) {
+/**
+ * @brief Set values of all enabled criteria using their reference calculations
+ *
+ * @tparam Function function setting the value of calculation
+ * @param scores scores to set
+ * @param function function to be called with each calculation
+ */
+template<typename Function>
+static void setCriteria(Scores & scores, Function function) {
+    setCriterion<BonusesScore>(scores, Criterion::Bonuses, function);
+    setCriterion<CoherentInDayScore>(scores, Criterion::CoherentInDay, function);
+    setCriterion<CoherentInWeekScore>(scores, Criterion::CoherentInWeek, function);
+    setCriterion<CollisionsScore>(scores, Criterion::Collisions, function);
+    setCriterion<ManyConsecutiveHoursScore>(scores, Criterion::ManyConsecutiveHours, function);
+    setCriterion<WrongStartTimesScore>(scores, Criterion::WrongStartTime, function);
+}
 
-        auto retrievedScore = s.scores.at(score.first);
+Scores & Scores::setToLowerBounds(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) {
 
-        score.second->value = std::min(score.second->value, retrievedScore->value);
-    }
+    setCriteria(*this, [ & ] (Score & score) {
+        score.value = score.lowerBound(schedules, p);
+        });
 
     return *this;
 }
 
-Scores & Scores::setToMaxValuesFrom(const Scores & s) {
-
-    for (auto & score : scores) {
-
-        auto retrievedScore = s.scores.at(score.first);
+Scores & Scores::setToUpperBounds(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) {
 
-        score.second->value = std::max(score.second->value, retrievedScore->value);
-    }
+    setCriteria(*this, [ & ] (Score & score) {
+        score.value = score.upperBound(schedules, p);
+        });
 
     return *this;
 }
 
-void Scores::calculateScore(std::vector<IntervalEntry> & intervals) {
+void Scores::calculateScore(std::vector<IntervalEntry> & intervals, const Priorities & p) {
 
     // Sort intervals by start time
     std::sort(intervals.begin(), intervals.end(), [ ] (const IntervalEntry & lhs, const IntervalEntry & rhs) -> bool {
@@ -83,69 +112,72 @@ void Scores::calculateScore(std::vector<IntervalEntry> & intervals) {
         });
 
 
-    for (auto & score : scores) {
-        score.second->calculateScore(intervals, priorities);
-    }
+    setCriteria(*this, [ & ] (Score & score) {
+        score.calculateScore(intervals, p);
+        });
 }
 
 double Scores::convertScoreToFitness(const Scores & minValues, const Scores & maxValues) const {
     double result = 0;
 
-    for (auto & score : scores) {
-
-        auto min = minValues.scores.at(score.first);
-        auto max = maxValues.scores.at(score.first);
+    for (size_t i = 0; i < CRITERIA_COUNT; i++) {
+        if (!isEnabled(static_cast<Criterion>(i))) {
+            continue;
+        }
 
-        result += score.second->getWeight() * inverseScoring(score.second->value, min->value, max->value);
+        result += CRITERIA[i].weight * inverseScoring(values[i], minValues.values[i], maxValues.values[i]);
     }
 
     return result;
 }
 
-double Scores::inverseScoring(double value, double min, double max) const {
+CriteriaMask Scores::enabledCriteria(const Priorities & p) {
+    CriteriaMask result = criterionBit(Criterion::Collisions) | criterionBit(Criterion::Bonuses);
 
-    if (value < min || value > max) {
-        throw std::invalid_argument("Value is out of min-max range.");
+    if (p.keepCoherentInDay) {
+        result |= criterionBit(Criterion::CoherentInDay);
     }
 
-    if (min == max) {
-        return 10;
+    if (p.keepCoherentInWeek) {
+        result |= criterionBit(Criterion::CoherentInWeek);
     }
 
-    double factor = 10.0 / (max - min);
-    double transformedValue = max - value;
+    if (p.penaliseAfterHour != 0 || p.penaliseBeforeHour != 0) {
+        result |= criterionBit(Criterion::WrongStartTime);
+    }
 
-    return transformedValue * factor;
+    if (p.penaliseManyConsecutiveHours != 0) {
+        result |= criterionBit(Criterion::ManyConsecutiveHours);
+    }
+
+    return result;
 }
 
-Score::Score() : value(0) { }
+// Range used for mapping to inverse scale when all reference values are equal
+#define SCORE_CALCULATION_EMPTYRANGE 1.0
 
-void Score::calculateScore(std::vector<IntervalEntry> & intervals, const Priorities & p) {
-    value = 0;
-}
+double Scores::inverseScoring(double value, double min, double max) {
 
-double CollisionsScore::getWeight() const {
-    return 0.6;
-}
+    // Only an empty range is widened, so ties still separate better and worse values
+    // and narrow ranges (e.g. fractional bonuses) keep their influence
+    if (max == min) {
+        min = max - SCORE_CALCULATION_EMPTYRANGE;
+    }
 
-double CoherentInDayScore::getWeight() const {
-    return 0.2;
-}
+    double factor = 10.0 / (max - min);
+    double transformedValue = max - value;
 
-double CoherentInWeekScore::getWeight() const {
-    return 0.2;
+    return transformedValue * factor;
 }
 
-double ManyConsecutiveHoursScore::getWeight() const {
-    return 0.07;
-}
+Score::Score() : value(0) { }
 
-double WrongStartTimesScore::getWeight() const {
-    return 0.13;
+void Score::calculateScore(std::vector<IntervalEntry> & intervals, const Priorities & p) {
+    value = 0;
 }
 
-double BonusesScore::getWeight() const {
-    return 0.2;
+double Score::lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    return 0;
 }
 
 void CollisionsScore::calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) {
@@ -154,7 +186,7 @@ void CollisionsScore::calculateScore(std::vector<IntervalEntry> & sortedInterval
     // Iterate through all intervals
     for (auto it = sortedIntervals.begin(); it != sortedIntervals.end(); it++) {
 
-        if (it->second->schedule.lock()->ignored) { // Skip ignored intervals
+        if (it->second.ignored) { // Skip ignored intervals
             continue;
         }
 
@@ -163,7 +195,7 @@ void CollisionsScore::calculateScore(std::vector<IntervalEntry> & sortedInterval
         while (collisionIt != sortedIntervals.end()
             && ((collisionIt->first.startTime < it->first.endTime) && (it->first.day == collisionIt->first.day))) {
 
-            if (collisionIt->second->schedule.lock()->ignored) { // Skip if the other interval is ignored
+            if (collisionIt->second.ignored) { // Skip if the other interval is ignored
                 collisionIt++;
                 continue;
             }
@@ -185,13 +217,13 @@ void CoherentInDayScore::calculateScore(std::vector<IntervalEntry> & sortedInter
 
     // Iterate through all intervals
     for (auto it = sortedIntervals.begin(); it != sortedIntervals.end(); it++) {
-        if (it->second->schedule.lock()->ignored) { // Skip ignored
+        if (it->second.ignored) { // Skip ignored
             continue;
         }
 
         auto next = it + 1;
         while (next != sortedIntervals.end() && it->first.day == next->first.day) { // FInd next interval that is not ingnored
-            if (next->second->schedule.lock()->ignored) {
+            if (next->second.ignored) {
                 next++;
                 continue;
             }
@@ -217,7 +249,7 @@ void CoherentInWeekScore::calculateScore(std::vector<IntervalEntry> & sortedInte
 
     auto beginIt = sortedIntervals.begin();
     while (beginIt != sortedIntervals.end()) { // Find first interval that is not ignored
-        if (!beginIt->second->schedule.lock()->ignored) {
+        if (!beginIt->second.ignored) {
             break;
         }
         beginIt++;
@@ -229,7 +261,7 @@ void CoherentInWeekScore::calculateScore(std::vector<IntervalEntry> & sortedInte
 
     auto endIt = sortedIntervals.rbegin();
     while (endIt != sortedIntervals.rend()) { // Find last interval that is not ignored
-        if (!endIt->second->schedule.lock()->ignored) {
+        if (!endIt->second.ignored) {
             break;
         }
         endIt++;
@@ -255,7 +287,7 @@ void ManyConsecutiveHoursScore::calculateScore(std::vector<IntervalEntry> & sort
     auto it = sortedIntervals.begin();
     while (it != sortedIntervals.end()) { // Iterate through all intervals
 
-        if (it->second->schedule.lock()->ignored) { // Skip over ignored intervals
+        if (it->second.ignored) { // Skip over ignored intervals
             it++;
             continue;
         }
@@ -291,29 +323,44 @@ void ManyConsecutiveHoursScore::calculateScore(std::vector<IntervalEntry> & sort
 // Default score to add for any start time out of prefferred bounds
 #define SCORE_CALCULATION_WRONGSTARTTIMEDEFAULT 60
 
+/**
+ * @brief Penalty for interval starting out of preferred bounds
+ *
+ * @param interval interval
+ * @param p priorities for timetable generation
+ * @return double penalty
+ */
+static double wrongStartTimePenalty(const TimeInterval & interval, const Priorities & p) {
+    double penalty = 0;
+
+    if (p.penaliseBeforeHour != 0) {
+        // Check if interval starts before preferred bound and raise wrong start times score
+        TimeInterval::TimeStamp penalisationBeforeTime(p.penaliseBeforeHour, 0);
+        if (interval.startTime.valueInMinutes() <= penalisationBeforeTime.valueInMinutes()) {
+            penalty += SCORE_CALCULATION_WRONGSTARTTIMEDEFAULT + (penalisationBeforeTime.valueInMinutes() - interval.startTime.valueInMinutes());
+        }
+    }
+    if (p.penaliseAfterHour != 0) {
+        // Check if interval starts after preferred bound and raise wrong start times score
+        TimeInterval::TimeStamp penalisationAfterTime(p.penaliseAfterHour, 0);
+        if (interval.startTime.valueInMinutes() >= penalisationAfterTime.valueInMinutes()) {
+            penalty += SCORE_CALCULATION_WRONGSTARTTIMEDEFAULT + (interval.startTime.valueInMinutes() - penalisationAfterTime.valueInMinutes());
+        }
+    }
+
+    return penalty;
+}
+
 void WrongStartTimesScore::calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) {
     Score::calculateScore(sortedIntervals, p);
 
     // Iterate through all intervals
     for (auto it = sortedIntervals.begin(); it != sortedIntervals.end(); it++) {
-        if (it->second->schedule.lock()->ignored) { // Skip over ignored intervals
+        if (it->second.ignored) { // Skip over ignored intervals
             continue;
         }
 
-        if (p.penaliseBeforeHour != 0) {
-            // Check if interval starts before preferred bound and raise wrong start times score
-            TimeInterval::TimeStamp penalisationBeforeTime(p.penaliseBeforeHour, 0);
-            if (it->first.startTime.valueInMinutes() <= penalisationBeforeTime.valueInMinutes()) {
-                value += SCORE_CALCULATION_WRONGSTARTTIMEDEFAULT + (penalisationBeforeTime.valueInMinutes() - it->first.startTime.valueInMinutes());
-            }
-        }
-        if (p.penaliseAfterHour != 0) {
-            // Check if interval starts after preferred bound and raise wrong start times score
-            TimeInterval::TimeStamp penalisationAfterTime(p.penaliseAfterHour, 0);
-            if (it->first.startTime.valueInMinutes() >= penalisationAfterTime.valueInMinutes()) {
-                value += SCORE_CALCULATION_WRONGSTARTTIMEDEFAULT + (it->first.startTime.valueInMinutes() - penalisationAfterTime.valueInMinutes());
-            }
-        }
+        value += wrongStartTimePenalty(it->first, p);
     }
 }
 
@@ -323,34 +370,254 @@ void BonusesScore::calculateScore(std::vector<IntervalEntry> & sortedIntervals,
     // Iterate through all intervals
     for (auto it = sortedIntervals.begin(); it != sortedIntervals.end(); it++) {
 
-        if (it->second->schedule.lock()->ignored) { // Skip over ignored intervals
+        if (it->second.ignored) { // Skip over ignored intervals
             continue;
         }
 
-        value += it->second->getBonus();
+        value += it->second.bonus;
     }
 }
 
-CollisionsScore * CollisionsScore::clone() const {
-    return new CollisionsScore(*this);
+double CollisionsScore::upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    double result = 0;
+
+    // Count collisions of two entries (or of entry with itself)
+    auto collisions = [ ] (const Entry & lhs, const Entry & rhs, bool same) -> double {
+        double count = 0;
+        for (size_t i = 0; i < lhs.timeslots.size(); i++) {
+            for (size_t j = (same ? i + 1 : 0); j < rhs.timeslots.size(); j++) {
+                if (lhs.timeslots[i].collidesWith(rhs.timeslots[j])) {
+                    count++;
+                }
+            }
+        }
+        return count;
+        };
+
+    // Any pair of schedules collides at most as much as their worst pair of entries
+    for (size_t lIndex = 0; lIndex < schedules.size(); lIndex++) {
+        const Schedule & lSchedule = *schedules[lIndex];
+        if (lSchedule.ignored) {
+            continue;
+        }
+
+        double worst = 0;
+        for (auto & entry : lSchedule.entriesPtrs) {
+            worst = std::max(worst, collisions(*entry, *entry, true));
+        }
+        result += worst;
+
+        for (size_t rIndex = lIndex + 1; rIndex < schedules.size(); rIndex++) {
+            const Schedule & rSchedule = *schedules[rIndex];
+            if (rSchedule.ignored) {
+                continue;
+            }
+
+            worst = 0;
+            for (auto & lEntry : lSchedule.entriesPtrs) {
+                for (auto & rEntry : rSchedule.entriesPtrs) {
+                    worst = std::max(worst, collisions(*lEntry, *rEntry, false));
+                }
+            }
+            result += worst;
+        }
+    }
+
+    return result;
 }
 
-CoherentInDayScore * CoherentInDayScore::clone() const {
-    return new CoherentInDayScore(*this);
+double CoherentInDayScore::upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    // There is at most one gap between each two following intervals
+    double intervals = 0;
+    for (auto & schedule : schedules) {
+        if (schedule->ignored) {
+            continue;
+        }
+
+        size_t most = 0;
+        for (auto & entry : schedule->entriesPtrs) {
+            most = std::max(most, entry->timeslots.size());
+        }
+        intervals += most;
+    }
+
+    return std::max(intervals - 1, 0.0);
 }
 
-CoherentInWeekScore * CoherentInWeekScore::clone() const {
-    return new CoherentInWeekScore(*this);
+double CoherentInWeekScore::lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    // Week is at least as long as the shortest choice of the most spread schedule
+    double result = 0;
+    for (auto & schedule : schedules) {
+        if (schedule->ignored || schedule->entriesPtrs.empty()) {
+            continue;
+        }
+
+        double shortest = std::numeric_limits<double>::max();
+        for (auto & entry : schedule->entriesPtrs) {
+            if (entry->timeslots.empty()) {
+                shortest = 0;
+                continue;
+            }
+
+            auto [ first, last ] = std::minmax_element(entry->timeslots.begin(), entry->timeslots.end(),
+                [ ] (const TimeInterval & lhs, const TimeInterval & rhs) -> bool {
+                    return lhs.day < rhs.day;
+                });
+            shortest = std::min(shortest, static_cast<double>(static_cast<size_t>(last->day) - static_cast<size_t>(first->day)));
+        }
+        result = std::max(result, shortest);
+    }
+
+    return result;
 }
 
-ManyConsecutiveHoursScore * ManyConsecutiveHoursScore::clone() const {
-    return new ManyConsecutiveHoursScore(*this);
+double CoherentInWeekScore::upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    // Week is at most as long as the span of all entries
+    size_t first = std::numeric_limits<size_t>::max();
+    size_t last = 0;
+    for (auto & schedule : schedules) {
+        if (schedule->ignored) {
+            continue;
+        }
+
+        for (auto & entry : schedule->entriesPtrs) {
+            for (auto & interval : entry->timeslots) {
+                first = std::min(first, static_cast<size_t>(interval.day));
+                last = std::max(last, static_cast<size_t>(interval.day));
+            }
+        }
+    }
+
+    if (first > last) {
+        return 0;
+    }
+
+    return last - first;
 }
 
-WrongStartTimesScore * WrongStartTimesScore::clone() const {
-    return new WrongStartTimesScore(*this);
+double ManyConsecutiveHoursScore::upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+
+    // Span of each day over all entries, no consecutive run can be longer
+    std::array<uint32_t, 7> firstStart;
+    std::array<uint32_t, 7> lastEnd;
+    firstStart.fill(std::numeric_limits<uint32_t>::max());
+    lastEnd.fill(0);
+    for (auto & schedule : schedules) {
+        for (auto & entry : schedule->entriesPtrs) {
+            for (auto & interval : entry->timeslots) {
+                size_t day = static_cast<size_t>(interval.day);
+                firstStart[day] = std::min(firstStart[day], interval.startTime.valueInMinutes());
+                lastEnd[day] = std::max(lastEnd[day], interval.endTime.valueInMinutes());
+            }
+        }
+    }
+
+    // Highest penalty of one run starting in given day
+    auto runPenalty = [ & ] (const TimeInterval & interval) -> double {
+        size_t day = static_cast<size_t>(interval.day);
+        double length = lastEnd[day] - firstStart[day];
+        return std::max(length - p.penaliseManyConsecutiveHours * 60, 0.0);
+        };
+
+    // Each run starts with an interval that is not ignored,
+    // except the first run that can start with any interval
+    double result = 0;
+    double firstRun = 0;
+    for (auto & schedule : schedules) {
+        double worst = 0;
+        for (auto & entry : schedule->entriesPtrs) {
+            double entryPenalty = 0;
+            for (auto & interval : entry->timeslots) {
+                entryPenalty += runPenalty(interval);
+                firstRun = std::max(firstRun, runPenalty(interval));
+            }
+            worst = std::max(worst, entryPenalty);
+        }
+
+        if (!schedule->ignored) {
+            result += worst;
+        }
+    }
+
+    return result + firstRun;
+}
+
+double WrongStartTimesScore::lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    // Each schedule has at least the penalty of its best entry
+    double result = 0;
+    for (auto & schedule : schedules) {
+        if (schedule->ignored || schedule->entriesPtrs.empty()) {
+            continue;
+        }
+
+        double best = std::numeric_limits<double>::max();
+        for (auto & entry : schedule->entriesPtrs) {
+            double penalty = 0;
+            for (auto & interval : entry->timeslots) {
+                penalty += wrongStartTimePenalty(interval, p);
+            }
+            best = std::min(best, penalty);
+        }
+        result += best;
+    }
+
+    return result;
+}
+
+double WrongStartTimesScore::upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    // Each schedule has at most the penalty of its worst entry
+    double result = 0;
+    for (auto & schedule : schedules) {
+        if (schedule->ignored) {
+            continue;
+        }
+
+        double worst = 0;
+        for (auto & entry : schedule->entriesPtrs) {
+            double penalty = 0;
+            for (auto & interval : entry->timeslots) {
+                penalty += wrongStartTimePenalty(interval, p);
+            }
+            worst = std::max(worst, penalty);
+        }
+        result += worst;
+    }
+
+    return result;
 }
 
-BonusesScore * BonusesScore::clone() const {
-    return new BonusesScore(*this);
-}
\ No newline at end of file
+double BonusesScore::lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    // Bonus is counted for every interval of entry
+    double result = 0;
+    for (auto & schedule : schedules) {
+        if (schedule->ignored || schedule->entriesPtrs.empty()) {
+            continue;
+        }
+
+        double lowest = std::numeric_limits<double>::max();
+        for (auto & entry : schedule->entriesPtrs) {
+            lowest = std::min(lowest, entry->getBonus() * entry->timeslots.size());
+        }
+        result += lowest;
+    }
+
+    return result;
+}
+
+double BonusesScore::upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const {
+    // Bonus is counted for every interval of entry
+    double result = 0;
+    for (auto & schedule : schedules) {
+        if (schedule->ignored || schedule->entriesPtrs.empty()) {
+            continue;
+        }
+
+        double highest = std::numeric_limits<double>::lowest();
+        for (auto & entry : schedule->entriesPtrs) {
+            highest = std::max(highest, entry->getBonus() * entry->timeslots.size());
+        }
+        result += highest;
+    }
+
+    return result;
+}
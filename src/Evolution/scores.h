@@ -15,7 +15,60 @@
 #include "Data/priorities.h"
 
 #include <vector>
+#include <array>
+#include <cstdint>
 
+/**
+ * @brief Criteria of timetable scoring
+ *
+ * Index of criterion in Scores, fitness is summed in this order.
+ *
+ */
+enum class Criterion : size_t {
+    Bonuses,
+    CoherentInDay,
+    CoherentInWeek,
+    Collisions,
+    ManyConsecutiveHours,
+    WrongStartTime
+};
+
+inline constexpr size_t CRITERIA_COUNT = 6; //!< Number of criteria
+
+/**
+ * @brief Description of criterion
+ *
+ */
+struct CriterionInfo {
+    const char * name; //!< Name of criterion
+    double weight; //!< Weight of criterion in fitness
+};
+
+/**
+ * @brief Table of all criteria, indexed by Criterion
+ *
+ */
+inline constexpr std::array<CriterionInfo, CRITERIA_COUNT> CRITERIA = { {
+    { "bonuses", 0.2 },
+    { "coherentInDay", 0.2 },
+    { "coherentInWeek", 0.2 },
+    { "collisions", 0.6 },
+    { "manyConsecutiveHours", 0.07 },
+    { "wrongStartTime", 0.13 }
+} };
+
+/**
+ * @brief Set of enabled criteria, one bit for each Criterion
+ *
+ */
+using CriteriaMask = uint32_t;
+
+/**
+ * @brief Reference calculation of one criterion
+ *
+ * Each criterion is calculated separately from sorted intervals.
+ *
+ */
 struct Score {
     double value;
 
@@ -23,8 +76,6 @@ struct Score {
 
     virtual ~Score() = default;
 
-    virtual double getWeight() const = 0;
-
     /**
      * @brief Calculate this score's value
      *
@@ -32,59 +83,80 @@ struct Score {
      *
      * A superclass method should be called first.
      *
-     * @see Scores.bonuses
-     *
      * @param sortedIntervals intervals and it's entry
      * @param p priorities for timetable generation
      */
     virtual void calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p);
 
     /**
-     * @brief Clone this score
+     * @brief Lowest value this score can reach in any timetable
+     *
+     * @param schedules all schedules of the timetable
+     * @param p priorities for timetable generation
+     * @return double lower bound
+     */
+    virtual double lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const;
+
+    /**
+     * @brief Highest value this score can reach in any timetable
      *
-     * @return Score* cloned score
+     * @param schedules all schedules of the timetable
+     * @param p priorities for timetable generation
+     * @return double upper bound
      */
-    virtual Score * clone() const = 0;
+    virtual double upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const = 0;
 };
 
 /**
  * @brief Scores for selected Entries
  *
+ * Plain values of all criteria, disabled criteria stay zero and are not part of fitness.
  * Fitness value is calculated based on these scores.
  *
  */
 struct Scores {
-private:
-    Priorities priorities;
-
-public:
-    std::map<std::string, std::shared_ptr<Score>> scores; //!< All scores
+    std::array<double, CRITERIA_COUNT> values; //!< Values of criteria, indexed by Criterion
+    CriteriaMask enabled; //!< Enabled criteria
 
     Scores() = delete;
 
-    ~Scores();
+    /**
+     * @brief Construct a new Scores object
+     *
+     * @param p priorities to base the enabled criteria on
+     */
+    Scores(const Priorities & p);
 
     /**
      * @brief Construct a new Scores object
      *
-     * @param s Scores to copy from
+     * @param e enabled criteria
      */
-    Scores(const Scores & s);
+    Scores(CriteriaMask e);
 
     /**
-     * @brief Assignment operator
+     * @brief Value of criterion
      *
-     * @param s score to assign from
-     * @return Scores& this
+     * @param c criterion
+     * @return double& value
      */
-    Scores & operator=(const Scores & s);
+    double & operator[](Criterion c);
 
     /**
-     * @brief Construct a new Scores object
+     * @brief Value of criterion
      *
-     * @param p priorities to base the scores on
+     * @param c criterion
+     * @return double value
      */
-    Scores(const Priorities & p);
+    double operator[](Criterion c) const;
+
+    /**
+     * @brief Check if criterion is enabled
+     *
+     * @param c criterion
+     * @return true criterion is enabled
+     */
+    bool isEnabled(Criterion c) const;
 
     /**
      * @brief Sets the scores to minimum value from another score
@@ -93,8 +165,6 @@ public:
      *
      * @param s another score
      * @return Scores& this
-     *
-     * @throws std::out_of_range the score types are not the same
      */
     Scores & setToMinValuesFrom(const Scores & s);
 
@@ -105,33 +175,60 @@ public:
      *
      * @param s another score
      * @return Scores& this
-     *
-     * @throws std::out_of_range the score types are not the same
      */
     Scores & setToMaxValuesFrom(const Scores & s);
 
+    /**
+     * @brief Sets the scores to lowest values any timetable can reach
+     *
+     * Bounds depend only on the problem, not on any generation.
+     *
+     * @param schedules all schedules of the timetable
+     * @param p priorities for timetable generation
+     * @return Scores& this
+     */
+    Scores & setToLowerBounds(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p);
+
+    /**
+     * @brief Sets the scores to highest values any timetable can reach
+     *
+     * Bounds depend only on the problem, not on any generation.
+     *
+     * @param schedules all schedules of the timetable
+     * @param p priorities for timetable generation
+     * @return Scores& this
+     */
+    Scores & setToUpperBounds(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p);
+
     /**
      * @brief Calculate all scores for selected Entries
      *
      * @param intervals intervals and it's entry
      * @param p priorities for timetable generation
      */
-    void calculateScore(std::vector<IntervalEntry> & intervals);
+    void calculateScore(std::vector<IntervalEntry> & intervals, const Priorities & p);
 
     /**
      * @brief Calculate fitness out of scores
      *
-     * Requires minimum and maximum scores reached in this generation
+     * Requires reference minimum and maximum scores (e.g. reached in previous generation),
+     * scores outside of them are extrapolated, so fitness can be calculated
+     * for each genome as soon as it is scored.
      *
-     * @param minValues minimum scores reached in this generation
-     * @param maxValues maximum scores reached in this generation
-     * @param p priorities for timetable generation
+     * @param minValues reference minimum scores
+     * @param maxValues reference maximum scores
      * @return double fitness
-     *
-     * @throws std::out_of_range the score types are not the same
      */
     double convertScoreToFitness(const Scores & minValues, const Scores & maxValues) const;
 
+    /**
+     * @brief Criteria enabled by priorities
+     *
+     * @param p priorities for timetable generation
+     * @return CriteriaMask enabled criteria
+     */
+    static CriteriaMask enabledCriteria(const Priorities & p);
+
 private:
 
     /**
@@ -140,15 +237,15 @@ private:
      * Values are mapped in inverse to 0-10 scale, with the spacing between them kept proportionate.
      *
      * Largest value is mapped to smallest (0), smallest value is mapped to largest (10).
-     *
-     * @throws std::invalid_argument value is larger than max or smaller than min
+     * Values out of range are mapped beyond the scale. Empty range (all reference values
+     * are equal) is widened to one, so differences from the reference value are not lost.
      *
      * @param value value to map
      * @param min minimum value
      * @param max maximum value
      * @return double mapped value
      */
-    inline double inverseScoring(double value, double min, double max) const;
+    static inline double inverseScoring(double value, double min, double max);
 
 };
 
@@ -160,11 +257,9 @@ private:
  */
 struct CollisionsScore : public Score {
 
-    double getWeight() const override;
-
     void calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) override;
 
-    CollisionsScore * clone() const override;
+    double upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
 };
 
 /**
@@ -175,11 +270,9 @@ struct CollisionsScore : public Score {
  */
 struct CoherentInDayScore : public Score {
 
-    double getWeight() const override;
-
     void calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) override;
 
-    CoherentInDayScore * clone() const override;
+    double upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
 };
 
 /**
@@ -190,11 +283,11 @@ struct CoherentInDayScore : public Score {
  */
 struct CoherentInWeekScore : public Score {
 
-    double getWeight() const override;
-
     void calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) override;
 
-    CoherentInWeekScore * clone() const override;
+    double lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
+
+    double upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
 };
 
 /**
@@ -205,11 +298,9 @@ struct CoherentInWeekScore : public Score {
  */
 struct ManyConsecutiveHoursScore : public Score {
 
-    double getWeight() const override;
-
     void calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) override;
 
-    ManyConsecutiveHoursScore * clone() const override;
+    double upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
 };
 
 /**
@@ -220,11 +311,11 @@ struct ManyConsecutiveHoursScore : public Score {
  */
 struct WrongStartTimesScore : public Score {
 
-    double getWeight() const override;
-
     void calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) override;
 
-    WrongStartTimesScore * clone() const override;
+    double lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
+
+    double upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
 };
 
 /**
@@ -235,11 +326,11 @@ struct WrongStartTimesScore : public Score {
  */
 struct BonusesScore : public Score {
 
-    double getWeight() const override;
-
     void calculateScore(std::vector<IntervalEntry> & sortedIntervals, const Priorities & p) override;
 
-    BonusesScore * clone() const override;
+    double lowerBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
+
+    double upperBound(const std::vector<std::shared_ptr<Schedule>> & schedules, const Priorities & p) const override;
 };
 
 #endif /* SCORES_H */
\ No newline at end of file
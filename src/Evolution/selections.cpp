@@ -0,0 +1,117 @@
+#include "selections.h"
+
+#include <algorithm>
+
+// Selection pressure of linear ranking (expected number of selections of best genome), in range (1, 2]
+#define RANK_SELECTION_PRESSURE 1.8
+
+SelectionException::SelectionException(std::string message) : msg(std::move(message)) { }
+
+const char * SelectionException::what() const noexcept {
+    return msg.c_str();
+}
+
+void ParentSelection::prepare(size_t size) {
+    if (size == 0) {
+        throw SelectionException("Can't select from empty generation.");
+    }
+
+    generationSize = size;
+}
+
+size_t UniformSelection::select(Random & random) const {
+    return random.below(generationSize);
+}
+
+TournamentSelection::TournamentSelection(size_t k) : ParentSelection(), tournamentSize(k) {
+    if (tournamentSize == 0) {
+        throw SelectionException("Impossible size of tournament.");
+    }
+}
+
+size_t TournamentSelection::select(Random & random) const {
+    // Generation is sorted by fitness, so the best competitor has the lowest index
+    size_t winner = random.below(generationSize);
+    for (size_t i = 1; i < tournamentSize; i++) {
+        winner = std::min<size_t>(winner, random.below(generationSize));
+    }
+
+    return winner;
+}
+
+void RankSelection::prepare(size_t size) {
+    if (size != 0 && size == generationSize) { // Table depends only on size of generation
+        return;
+    }
+
+    ParentSelection::prepare(size);
+
+    // Linear ranking weights scaled so their mean is one
+    std::vector<double> weights(size, 1);
+    if (size > 1) {
+        for (size_t rank = 0; rank < size; rank++) {
+            weights[rank] = RANK_SELECTION_PRESSURE - (2 * (RANK_SELECTION_PRESSURE - 1) * rank) / (size - 1);
+        }
+    }
+
+    // Build alias table (Vose's method), split columns to smaller and larger than mean
+    probabilities.assign(size, 1);
+    aliases.assign(size, 0);
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < size; i++) {
+        aliases[i] = i;
+        if (weights[i] < 1) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+
+    // Fill each smaller column with the rest from a larger one
+    while (!small.empty() && !large.empty()) {
+        size_t less = small.back();
+        small.pop_back();
+        size_t more = large.back();
+
+        probabilities[less] = weights[less];
+        aliases[less] = more;
+
+        weights[more] -= (1 - weights[less]);
+        if (weights[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // Columns that are left (due to rounding) are kept whole
+    for (size_t i : small) {
+        probabilities[i] = 1;
+    }
+    for (size_t i : large) {
+        probabilities[i] = 1;
+    }
+}
+
+size_t RankSelection::select(Random & random) const {
+    size_t column = random.below(generationSize);
+    double coin = random.uniform();
+
+    return (coin < probabilities[column]) ? column : aliases[column];
+}
+
+TruncationSelection::TruncationSelection(double r) : ParentSelection(), ratio(r), truncatedSize(0) {
+    if (ratio <= 0 || ratio > 1) {
+        throw SelectionException("Impossible truncation ratio.");
+    }
+}
+
+void TruncationSelection::prepare(size_t size) {
+    ParentSelection::prepare(size);
+
+    truncatedSize = std::max<size_t>(static_cast<size_t>(size * ratio), 1);
+}
+
+size_t TruncationSelection::select(Random & random) const {
+    return random.below(truncatedSize);
+}
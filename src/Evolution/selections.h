@@ -0,0 +1,152 @@
+/**
+ * @file selections.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Parent selections for genetic algorithm
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef SELECTIONS_H
+#define SELECTIONS_H
+
+#include "Evolution/random.h"
+
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <string>
+
+/**
+ * @brief Exception thrown by parent selection
+ *
+ */
+struct SelectionException : public std::exception {
+
+    SelectionException(std::string message);
+
+    const char * what() const noexcept override;
+
+private:
+
+    std::string msg;
+};
+
+/**
+ * @brief Parent selection operation
+ *
+ * Selects index of a parent from generation sorted by fitness (best genome first).
+ *
+ * Abstract class, should be subclassed with specific implementation.
+ *
+ */
+struct ParentSelection {
+
+    virtual ~ParentSelection() = default;
+
+    /**
+     * @brief Prepare selection for a generation
+     *
+     * Has to be called before selecting from a generation of different size.
+     * Is not thread safe, selecting is.
+     *
+     * @throws SelectionException if generation size is zero
+     *
+     * @param size size of generation
+     */
+    virtual void prepare(size_t size);
+
+    /**
+     * @brief Select parent
+     *
+     * @param random random number generator of the calling worker
+     * @return size_t index of parent in generation sorted by fitness
+     */
+    virtual size_t select(Random & random) const = 0;
+
+protected:
+
+    size_t generationSize = 0; //!< Size of generation the selection was prepared for
+};
+
+/**
+ * @brief Uniform parent selection
+ *
+ * Each genome is selected with equal probability.
+ *
+ */
+struct UniformSelection : ParentSelection {
+
+    size_t select(Random & random) const override;
+};
+
+/**
+ * @brief Tournament parent selection
+ *
+ * Several genomes are picked uniformly, the best of them is selected.
+ *
+ */
+struct TournamentSelection : ParentSelection {
+private:
+    size_t tournamentSize; // Number of genomes competing in one tournament
+
+public:
+    /**
+     * @brief Construct a new Tournament Selection operator
+     *
+     * @throws SelectionException if tournament size is zero
+     *
+     * @param k number of genomes competing in one tournament
+     */
+    TournamentSelection(size_t k);
+
+    size_t select(Random & random) const override;
+};
+
+/**
+ * @brief Rank-based parent selection
+ *
+ * Linear ranking, probability of selection decreases linearly with rank
+ * of genome. Sampling uses alias table, so each selection takes constant time.
+ *
+ */
+struct RankSelection : ParentSelection {
+private:
+    std::vector<double> probabilities; // Probability of keeping the drawn column of alias table
+    std::vector<size_t> aliases; // Alternative index for each column of alias table
+
+public:
+    void prepare(size_t size) override;
+
+    size_t select(Random & random) const override;
+};
+
+/**
+ * @brief Truncation parent selection
+ *
+ * Only the best part of generation can be selected, uniformly.
+ *
+ */
+struct TruncationSelection : ParentSelection {
+private:
+    double ratio; // Part of generation that can be selected
+    size_t truncatedSize; // Number of genomes that can be selected
+
+public:
+    /**
+     * @brief Construct a new Truncation Selection operator
+     *
+     * @throws SelectionException if ratio is not in range (0, 1]
+     *
+     * @param r part of generation that can be selected
+     */
+    TruncationSelection(double r);
+
+    void prepare(size_t size) override;
+
+    size_t select(Random & random) const override;
+};
+
+#endif /* SELECTIONS_H */
@@ -0,0 +1,31 @@
+#include "settings.h"
+
+#include <random>
+
+EvolutionSettings::EvolutionSettings() :
+    threadCount(0),
+    seed(std::random_device()()),
+    offspringMultiplier(7),
+    parentSelection(ParentSelectionType::Tournament),
+    tournamentSize(3),
+    truncationRatio(0.5),
+    fitnessNormalisation(FitnessNormalisation::Population),
+    cacheSize(16384),
+    localSearchElites(0),
+    localSearch(LocalSearchType::FirstImprovement),
+    localSearchEvaluations(10000),
+    stagnationLimit(0),
+    improvementWindow(0),
+    minimalImprovement(0.01),
+    stopAtLowerBounds(false),
+    diversityThreshold(0) { }
+
+IslandSettings::IslandSettings() :
+    islandCount(0),
+    migrationInterval(10),
+    migrantCount(2),
+    topology(MigrationTopology::Ring) { }
+
+ExactSearchSettings::ExactSearchSettings() :
+    nodeLimit(10000000),
+    timeLimit(0) { }
@@ -0,0 +1,129 @@
+/**
+ * @file settings.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Data structures describing settings of the evolution algorithm
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Type of parent selection
+ *
+ * @see ParentSelection
+ *
+ */
+enum class ParentSelectionType {
+    Uniform,
+    Tournament,
+    Rank,
+    Truncation
+};
+
+/**
+ * @brief Reference scores, against which fitness is calculated
+ *
+ */
+enum class FitnessNormalisation {
+    Population, //!< Scores reached by the current generation
+    Static //!< Bounds of scores any timetable can reach, calculated once from the problem
+};
+
+/**
+ * @brief Moves of local search
+ *
+ */
+enum class LocalSearchType {
+    FirstImprovement, //!< Every improving change of a gene is taken at once
+    SteepestDescent //!< Only the best change of all genes is taken in each pass
+};
+
+/**
+ * @brief Islands receiving migrants from each island
+ *
+ */
+enum class MigrationTopology {
+    Ring, //!< Each island sends to the next one, the last one to the first one
+    Random //!< Each island sends to a random other island every migration
+};
+
+/**
+ * @brief Representation of settings for running the evolution algorithm
+ *
+ * Unlike Priorities, these do not change what timetable is considered best,
+ * only how the algorithm searches for it.
+ *
+ */
+struct EvolutionSettings {
+
+    size_t threadCount; //!< Threads used for creating and scoring offsprings (zero for all hardware threads, default 0)
+
+    uint64_t seed; //!< Master seed of all random streams, same seed gives same timetable for any thread count (default random)
+
+    size_t offspringMultiplier; //!< Offsprings created per genome of generation (if zero, generation size is used, default 7)
+
+    ParentSelectionType parentSelection; //!< How parents of offsprings are selected (default tournament)
+    size_t tournamentSize; //!< Genomes competing in tournament selection (default 3)
+    double truncationRatio; //!< Part of generation that can be selected by truncation selection (default 0.5)
+
+    FitnessNormalisation fitnessNormalisation; //!< Reference scores for fitness (default population)
+
+    size_t cacheSize; //!< Maximum number of genomes with cached scores (zero disables cache, default 16384)
+
+    size_t localSearchElites; //!< Best genomes improved by 1-opt local search every generation (zero disables, default 0)
+    LocalSearchType localSearch; //!< Moves of local search (default first improvement)
+    size_t localSearchEvaluations; //!< Changes of genes evaluated by local search in one generation, split among elites (default 10000)
+
+    // Evolution stops before the last generation when any of enabled conditions is met,
+    // quality of timetable is its fitness against scores of initial generation
+
+    size_t stagnationLimit; //!< Generations without improvement of best timetable before stopping (zero disables, default 0)
+    size_t improvementWindow; //!< Generations over which improvement of best timetable is measured (zero disables, default 0)
+    double minimalImprovement; //!< Improvement of quality of best timetable required over window (default 0.01)
+    bool stopAtLowerBounds; //!< Stop when best timetable reaches lowest possible value of every criterion (default false)
+    double diversityThreshold; //!< Stop when diversity of generation drops below it, in range 0-1 (zero disables, default 0)
+
+    EvolutionSettings();
+
+};
+
+/**
+ * @brief Settings of island model, in addition to settings of evolution on each island
+ *
+ */
+struct IslandSettings {
+
+    size_t islandCount; //!< Number of islands, each runs on its own thread or process (zero for all hardware threads, default 0)
+
+    size_t migrationInterval; //!< Generations between migrations (zero disables migration, default 10)
+    size_t migrantCount; //!< Best genomes sent by island in one migration (default 2)
+    MigrationTopology topology; //!< Islands receiving migrants (default ring)
+
+    IslandSettings();
+
+};
+
+/**
+ * @brief Limits of exact search of timetable
+ *
+ * @see BranchAndBound
+ *
+ */
+struct ExactSearchSettings {
+
+    size_t nodeLimit; //!< Maximum number of visited search nodes (zero for no limit, default 10000000)
+    size_t timeLimit; //!< Maximum milliseconds of search (zero for no limit, default 0)
+
+    ExactSearchSettings();
+
+};
+
+#endif /* SETTINGS_H */
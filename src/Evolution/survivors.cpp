@@ -0,0 +1,98 @@
+#include "survivors.h"
+
+#include <algorithm>
+
+SurvivorPool::SurvivorPool(Population & t, Arena & arena) :
+    target(t),
+    capacity(t.getCapacity()),
+    rows(ArenaAllocator<uint32_t>(arena)),
+    mutex(),
+    threshold(std::numeric_limits<double>::lowest()) {
+
+    rows.reserve(capacity);
+    target.ranking.clear();
+}
+
+bool SurvivorPool::offer(GenomeView genome, uint64_t hash, const Scores & scores, double fitness, size_t order) {
+
+    // Genome worse than the worst kept one can be rejected without locking
+    if (capacity == 0 || fitness < threshold.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t row = admit(fitness, order);
+    if (row == capacity) {
+        return false;
+    }
+
+    target.genes.store(row, genome);
+    target.hashes[row] = hash;
+    target.scores[row] = scores;
+    return true;
+}
+
+bool SurvivorPool::offer(const Population & source, size_t row, double fitness, size_t order) {
+
+    if (capacity == 0 || fitness < threshold.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t targetRow = admit(fitness, order);
+    if (targetRow == capacity) {
+        return false;
+    }
+
+    target.genes.copyRow(targetRow, source.genes, row);
+    target.hashes[targetRow] = source.hashes[row];
+    target.scores[targetRow] = source.scores[row];
+    return true;
+}
+
+size_t SurvivorPool::rank() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Kept genomes always occupy the first rows
+    size_t count = rows.size();
+    target.rank(count);
+
+    rows.clear();
+    threshold.store(std::numeric_limits<double>::lowest(), std::memory_order_relaxed);
+
+    return count;
+}
+
+size_t SurvivorPool::admit(double fitness, size_t order) {
+    auto isBetter = [ & ] (uint32_t lhs, uint32_t rhs) {
+        return target.isBetter(lhs, rhs);
+        };
+
+    size_t row;
+    if (rows.size() < capacity) { // Pool is not full yet, keep everything
+        row = rows.size();
+    } else {
+        // Replace the worst kept genome if this one is better
+        size_t worst = rows.front();
+        if (fitness < target.fitness[worst] || (fitness == target.fitness[worst] && order > target.orders[worst])) {
+            return capacity;
+        }
+
+        std::pop_heap(rows.begin(), rows.end(), isBetter);
+        rows.pop_back();
+        row = worst;
+    }
+
+    target.fitness[row] = fitness;
+    target.orders[row] = order;
+    rows.push_back(static_cast<uint32_t>(row));
+    std::push_heap(rows.begin(), rows.end(), isBetter);
+
+    if (rows.size() == capacity) {
+        threshold.store(target.fitness[rows.front()], std::memory_order_relaxed);
+    }
+
+    return row;
+}
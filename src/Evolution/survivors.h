@@ -0,0 +1,111 @@
+/**
+ * @file survivors.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Bounded pool of best genomes for survivor selection
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef SURVIVORS_H
+#define SURVIVORS_H
+
+#include "Evolution/crossovers.h"
+#include "Evolution/population.h"
+#include "Evolution/scores.h"
+#include "Utility/arena.h"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <limits>
+
+/**
+ * @brief Bounded pool of best genomes
+ *
+ * Genomes are offered one by one as they are scored and kept only if they
+ * are among the best genomes offered so far. Kept genomes are written into rows
+ * of target population, a rejected or replaced genome only frees its row,
+ * so memory is bounded by capacity of the population no matter how many genomes are offered.
+ *
+ * Offering is thread safe. Genomes worse than the worst kept genome
+ * are rejected without locking.
+ *
+ */
+class SurvivorPool {
+
+    Population & target; // Population the kept genomes are written to
+    size_t capacity; // Maximum number of kept genomes
+    std::vector<uint32_t, ArenaAllocator<uint32_t>> rows; // Rows of kept genomes, heap with the worst genome on top
+
+    std::mutex mutex;
+    std::atomic<double> threshold; // Fitness of worst kept genome once full, else lowest value
+
+public:
+
+    SurvivorPool() = delete;
+
+    /**
+     * @brief Construct a new Survivor Pool object
+     *
+     * Ranking of target population is cleared.
+     *
+     * @param t population the kept genomes are written to, its capacity is the maximum number of kept genomes
+     * @param arena arena for bookkeeping of the pool, has to outlive it
+     */
+    SurvivorPool(Population & t, Arena & arena);
+
+    /**
+     * @brief Offer genome to pool
+     *
+     * Genome is copied to target population only if it is kept.
+     *
+     * @param genome genome
+     * @param hash hash of genome
+     * @param scores scores of genome
+     * @param fitness fitness of genome
+     * @param order order of genome, unique for each offered genome
+     * @return true genome was kept
+     * @return false genome was rejected
+     */
+    bool offer(GenomeView genome, uint64_t hash, const Scores & scores, double fitness, size_t order);
+
+    /**
+     * @brief Offer genome from other population to pool
+     *
+     * @param source population of the genome (not the target)
+     * @param row row of genome in source
+     * @param fitness fitness of genome
+     * @param order order of genome, unique for each offered genome
+     * @return true genome was kept
+     * @return false genome was rejected
+     */
+    bool offer(const Population & source, size_t row, double fitness, size_t order);
+
+    /**
+     * @brief Rank all kept genomes in target population
+     *
+     * The pool is empty afterwards.
+     *
+     * @return size_t number of kept genomes
+     */
+    size_t rank();
+
+private:
+
+    /**
+     * @brief Find row for genome, evicting the worst kept genome if full
+     *
+     * Has to be called under lock, genome has to be written to the returned row
+     * before the lock is released.
+     *
+     * @param fitness fitness of genome
+     * @param order order of genome
+     * @return size_t row for genome, capacity if genome is rejected
+     */
+    size_t admit(double fitness, size_t order);
+};
+
+#endif /* SURVIVORS_H */
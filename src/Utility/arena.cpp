@@ -0,0 +1,81 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+// Size of blocks used if none is given
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+Arena::Arena(size_t size) :
+    blockSize(size == 0 ? ARENA_DEFAULT_BLOCK_SIZE : size),
+    blocks(),
+    current(0),
+    offset(0),
+    allocations(0),
+    bytes(0) { }
+
+void * Arena::allocate(size_t size, size_t alignment) {
+    allocations++;
+
+    // Find first block (from current one) with enough free space
+    while (current < blocks.size()) {
+        Block & block = blocks[current];
+        uintptr_t start = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t aligned = ((start + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - start;
+        if (aligned + size <= block.size) {
+            offset = aligned + size;
+            return block.data.get() + aligned;
+        }
+
+        current++;
+        offset = 0;
+    }
+
+    // Request new block, large enough for the allocation
+    size_t newSize = std::max(blockSize, size + alignment);
+    blocks.push_back(Block { std::unique_ptr<std::byte[]>(new std::byte[newSize]), newSize });
+    bytes += newSize;
+
+    Block & block = blocks.back();
+    uintptr_t start = reinterpret_cast<uintptr_t>(block.data.get());
+    size_t aligned = ((start + alignment - 1) & ~(uintptr_t(alignment) - 1)) - start;
+    offset = aligned + size;
+    return block.data.get() + aligned;
+}
+
+void Arena::reset() {
+    current = 0;
+    offset = 0;
+}
+
+ArenaStatistics Arena::getStatistics() const {
+    return ArenaStatistics { allocations, blocks.size(), bytes };
+}
+
+WorkerArenas::WorkerArenas(size_t workerCount, size_t blockSize) : arenas() {
+    for (size_t i = 0; i < workerCount; i++) {
+        arenas.emplace_back(new Arena(blockSize));
+    }
+}
+
+Arena & WorkerArenas::forWorker(size_t worker) {
+    return *arenas[worker];
+}
+
+void WorkerArenas::reset() {
+    for (auto & arena : arenas) {
+        arena->reset();
+    }
+}
+
+ArenaStatistics WorkerArenas::getStatistics() const {
+    ArenaStatistics result;
+    for (auto & arena : arenas) {
+        ArenaStatistics statistics = arena->getStatistics();
+        result.allocations += statistics.allocations;
+        result.blocks += statistics.blocks;
+        result.bytes += statistics.bytes;
+    }
+
+    return result;
+}
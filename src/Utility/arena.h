@@ -0,0 +1,183 @@
+/**
+ * @file arena.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Monotonic allocation of short-lived data
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <memory>
+#include <span>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief Statistics of arena allocations
+ *
+ */
+struct ArenaStatistics {
+    size_t allocations = 0; //!< Allocations served by arenas
+    size_t blocks = 0; //!< Blocks requested by arenas from global allocator
+    size_t bytes = 0; //!< Bytes held by arenas
+};
+
+/**
+ * @brief Monotonic allocator
+ *
+ * Memory is handed out from large blocks by moving a cursor, single allocations
+ * are never freed. Reset rewinds the cursor to the first block, so all memory
+ * is freed at once and the blocks are reused.
+ *
+ * Is not thread safe, each thread should use its own arena.
+ *
+ */
+class alignas(64) Arena {
+
+    /**
+     * @brief Block of memory
+     *
+     */
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    size_t blockSize; // Size of newly requested blocks
+    std::vector<Block> blocks; // All blocks, the ones after current block are free
+    size_t current; // Index of block allocations are served from
+    size_t offset; // Used bytes of current block
+
+    size_t allocations; // Allocations served in total
+    size_t bytes; // Bytes of all blocks
+
+public:
+
+    /**
+     * @brief Construct a new Arena object, no memory is requested until first allocation
+     *
+     * @param size size of blocks requested from global allocator
+     */
+    Arena(size_t size = 0);
+
+    Arena(const Arena &) = delete;
+
+    Arena & operator=(const Arena &) = delete;
+
+    /**
+     * @brief Allocate memory
+     *
+     * @param size number of bytes
+     * @param alignment alignment (power of two)
+     * @return void* allocated memory, valid until reset
+     */
+    void * allocate(size_t size, size_t alignment);
+
+    /**
+     * @brief Allocate array, items are not initialised
+     *
+     * @tparam T trivial type of items
+     * @param count number of items
+     * @return std::span<T> allocated items, valid until reset
+     */
+    template<typename T>
+    std::span<T> allocateArray(size_t count) {
+        static_assert(std::is_trivial_v<T>, "Arena arrays are never destroyed.");
+        return std::span<T>(static_cast<T *>(allocate(count * sizeof(T), alignof(T))), count);
+    }
+
+    /**
+     * @brief Free all allocations at once, blocks are kept for reuse
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Get statistics of arena
+     *
+     * @return ArenaStatistics statistics
+     */
+    ArenaStatistics getStatistics() const;
+};
+
+/**
+ * @brief Allocator for standard containers using an arena
+ *
+ * Deallocation does nothing, memory is freed by reset of the arena.
+ *
+ * @tparam T type of items
+ */
+template<typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    Arena * arena; //!< Arena memory is taken from
+
+    ArenaAllocator(Arena & a) : arena(&a) { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> & other) : arena(other.arena) { }
+
+    T * allocate(size_t count) {
+        return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) { }
+
+    template<typename U>
+    bool operator == (const ArenaAllocator<U> & rhs) const {
+        return arena == rhs.arena;
+    }
+};
+
+/**
+ * @brief Arenas of workers of a thread pool
+ *
+ * Each worker allocates only from its own arena, so workers do not contend.
+ *
+ */
+class WorkerArenas {
+
+    std::vector<std::unique_ptr<Arena>> arenas; // Arena of each worker
+
+public:
+
+    WorkerArenas() = delete;
+
+    /**
+     * @brief Construct a new Worker Arenas object
+     *
+     * @param workerCount number of workers
+     * @param blockSize size of blocks requested by each arena
+     */
+    WorkerArenas(size_t workerCount, size_t blockSize = 0);
+
+    /**
+     * @brief Get arena of worker
+     *
+     * @param worker index of worker
+     * @return Arena& arena
+     */
+    Arena & forWorker(size_t worker);
+
+    /**
+     * @brief Free all allocations of all arenas
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Get statistics summed over all arenas
+     *
+     * @return ArenaStatistics statistics
+     */
+    ArenaStatistics getStatistics() const;
+};
+
+#endif /* ARENA_H */
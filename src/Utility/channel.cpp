@@ -0,0 +1,97 @@
+#include "channel.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Bytes of message header (type and length of payload)
+#define CHANNEL_HEADER_SIZE 5
+
+// Bytes read from socket at once
+#define CHANNEL_READ_SIZE 65536
+
+MessageChannel::MessageChannel(int d) : descriptor(d), buffer(), closed(false) { }
+
+MessageChannel::~MessageChannel() {
+    if (descriptor >= 0) {
+        ::close(descriptor);
+    }
+}
+
+std::pair<int, int> MessageChannel::createSocketPair() {
+    int sockets[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Unable to create socket pair");
+    }
+
+    return std::make_pair(sockets[0], sockets[1]);
+}
+
+int MessageChannel::getDescriptor() const {
+    return descriptor;
+}
+
+bool MessageChannel::isClosed() const {
+    return closed;
+}
+
+void MessageChannel::send(uint8_t type, const std::vector<uint8_t> & payload) {
+    std::vector<uint8_t> frame;
+    frame.reserve(CHANNEL_HEADER_SIZE + payload.size());
+    frame.push_back(type);
+    for (size_t i = 0; i < 4; i++) {
+        frame.push_back(static_cast<uint8_t>(payload.size() >> (8 * i)));
+    }
+    frame.insert(frame.end(), payload.begin(), payload.end());
+
+    size_t written = 0;
+    while (written < frame.size()) {
+        ssize_t result = ::send(descriptor, frame.data() + written, frame.size() - written, MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "Unable to send message");
+        }
+        written += result;
+    }
+}
+
+void MessageChannel::fill() {
+    uint8_t chunk[CHANNEL_READ_SIZE];
+
+    while (!closed) {
+        ssize_t result = ::recv(descriptor, chunk, sizeof(chunk), MSG_DONTWAIT);
+        if (result > 0) {
+            buffer.insert(buffer.end(), chunk, chunk + result);
+        } else if (result == 0 || errno == ECONNRESET) { // Reset when other side ended without reading everything
+            closed = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        } else {
+            throw std::system_error(errno, std::generic_category(), "Unable to receive message");
+        }
+    }
+}
+
+std::optional<Message> MessageChannel::next() {
+    if (buffer.size() < CHANNEL_HEADER_SIZE) {
+        return std::nullopt;
+    }
+
+    size_t length = 0;
+    for (size_t i = 0; i < 4; i++) {
+        length |= size_t(buffer[1 + i]) << (8 * i);
+    }
+    if (buffer.size() < CHANNEL_HEADER_SIZE + length) {
+        return std::nullopt;
+    }
+
+    Message result { buffer[0], std::vector<uint8_t>(buffer.begin() + CHANNEL_HEADER_SIZE, buffer.begin() + CHANNEL_HEADER_SIZE + length) };
+    buffer.erase(buffer.begin(), buffer.begin() + CHANNEL_HEADER_SIZE + length);
+    return result;
+}
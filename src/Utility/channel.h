@@ -0,0 +1,114 @@
+/**
+ * @file channel.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Framed messages over stream sockets
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <vector>
+#include <optional>
+#include <utility>
+#include <cstdint>
+
+/**
+ * @brief Message with type and binary payload
+ *
+ */
+struct Message {
+    uint8_t type; //!< Type of message, meaning is given by its user
+    std::vector<uint8_t> payload; //!< Content of message
+};
+
+/**
+ * @brief Channel of framed messages over a connected stream socket
+ *
+ * Each message is sent as its type (one byte), length of payload
+ * (four bytes, little endian) and payload. Works over any stream socket
+ * (Unix domain or TCP).
+ *
+ * Received bytes are buffered until a whole message arrives,
+ * so reading can be done without waiting.
+ *
+ */
+class MessageChannel {
+
+    int descriptor; // Socket, owned by channel
+    std::vector<uint8_t> buffer; // Received bytes not taken as messages yet
+    bool closed; // Other side closed the connection
+
+public:
+
+    MessageChannel() = delete;
+
+    /**
+     * @brief Construct a new Message Channel object
+     *
+     * @param d connected stream socket, closed by channel
+     */
+    MessageChannel(int d);
+
+    MessageChannel(const MessageChannel &) = delete;
+
+    MessageChannel & operator=(const MessageChannel &) = delete;
+
+    ~MessageChannel();
+
+    /**
+     * @brief Create pair of connected Unix domain sockets
+     *
+     * @throws std::system_error if sockets can't be created
+     *
+     * @return std::pair<int, int> two connected sockets
+     */
+    static std::pair<int, int> createSocketPair();
+
+    /**
+     * @brief Get socket of channel
+     *
+     * @return int socket, for waiting on multiple channels
+     */
+    int getDescriptor() const;
+
+    /**
+     * @brief Check if other side closed the connection
+     *
+     * Messages received before closing can still be taken.
+     *
+     * @return true connection is closed
+     * @return false connection is open
+     */
+    bool isClosed() const;
+
+    /**
+     * @brief Send message, waits until it is written to socket
+     *
+     * @throws std::system_error if writing fails
+     *
+     * @param type type of message
+     * @param payload content of message
+     */
+    void send(uint8_t type, const std::vector<uint8_t> & payload);
+
+    /**
+     * @brief Read all bytes available on socket without waiting
+     *
+     * @throws std::system_error if reading fails
+     */
+    void fill();
+
+    /**
+     * @brief Take next whole message from received bytes
+     *
+     * @return std::optional<Message> message, if whole one was received
+     */
+    std::optional<Message> next();
+};
+
+#endif /* CHANNEL_H */
@@ -0,0 +1,14 @@
+#include "cpu.h"
+
+bool hasAvx2() {
+#if defined(__x86_64__)
+    // Feature data has to be initialized before use, it may not be yet if called during static initialization
+    static const bool supported = [ ] () {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+        }();
+    return supported;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,26 @@
+/**
+ * @file cpu.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Features of the processor the program runs on
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef CPU_H
+#define CPU_H
+
+/**
+ * @brief Check if the processor supports AVX2
+ *
+ * Detected on the first call (not during static initialization), later calls return the stored result.
+ * Always false on architectures other than x86-64.
+ *
+ * @return true AVX2 instructions can be used
+ * @return false only scalar code can be used
+ */
+bool hasAvx2();
+
+#endif /* CPU_H */
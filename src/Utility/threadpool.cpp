@@ -0,0 +1,124 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) :
+    workers(),
+    mutex(),
+    wakeCondition(),
+    doneCondition(),
+    task(nullptr),
+    taskCount(0),
+    nextIndex(0),
+    busyWorkers(0),
+    epoch(0),
+    stopping(false),
+    failure() {
+
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Calling thread is the first worker, start only the rest
+    for (size_t i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)> & function) {
+
+    if (workers.empty()) { // Nothing to distribute, run in order on this thread
+        for (size_t i = 0; i < count; i++) {
+            function(i, 0);
+        }
+        return;
+    }
+
+    // Publish the loop to workers
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &function;
+        taskCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        busyWorkers = workers.size();
+        failure = nullptr;
+        epoch++;
+    }
+    wakeCondition.notify_all();
+
+    runIterations(function, count, 0);
+
+    // Wait for all workers to leave the loop, so the function can be safely destroyed
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [ this ] { return busyWorkers == 0; });
+    task = nullptr;
+
+    if (failure) {
+        std::exception_ptr thrown = failure;
+        failure = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    size_t seenEpoch = 0;
+
+    while (true) {
+        const std::function<void(size_t, size_t)> * function;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [ this, seenEpoch ] { return stopping || epoch != seenEpoch; });
+            if (stopping) {
+                return;
+            }
+            seenEpoch = epoch;
+            function = task;
+            count = taskCount;
+        }
+
+        runIterations(*function, count, worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::runIterations(const std::function<void(size_t, size_t)> & function, size_t count, size_t worker) {
+    while (true) {
+        size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        if (index >= count) {
+            return;
+        }
+
+        try {
+            function(index, worker);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+            nextIndex.store(count, std::memory_order_relaxed); // Skip remaining iterations
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * @file threadpool.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Pool of worker threads for parallel stages of the algorithm
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+/**
+ * @brief Pool of worker threads
+ *
+ * Threads are started once and reused for every parallel loop.
+ * The calling thread takes part in the work as the worker with index zero,
+ * so a pool with one thread runs everything on the calling thread in order.
+ *
+ */
+class ThreadPool {
+
+    std::vector<std::thread> workers; // Background threads (thread count - 1)
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition; // Signals workers that a new loop is available
+    std::condition_variable doneCondition; // Signals caller that all workers finished the loop
+
+    const std::function<void(size_t, size_t)> * task; // Body of currently running loop
+    size_t taskCount; // Number of iterations of currently running loop
+    std::atomic<size_t> nextIndex; // Next iteration to be taken by a worker
+    size_t busyWorkers; // Background workers that have not finished the current loop yet
+    size_t epoch; // Incremented for every loop, so workers can recognise a new one
+    bool stopping; // Pool is being destroyed
+
+    std::exception_ptr failure; // First exception thrown inside the current loop
+
+public:
+
+    ThreadPool() = delete;
+
+    /**
+     * @brief Construct a new Thread Pool object
+     *
+     * @param threadCount number of threads (including the calling thread),
+     * if zero, number of available hardware threads is used
+     */
+    ThreadPool(size_t threadCount);
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * @brief Get number of threads (including the calling thread)
+     *
+     * @return size_t thread count
+     */
+    size_t getThreadCount() const;
+
+    /**
+     * @brief Run function for every index in range [0, count) in parallel
+     *
+     * Blocks until all iterations are finished. If any iteration throws,
+     * the first exception is rethrown in the calling thread after the loop finishes.
+     *
+     * @param count number of iterations
+     * @param function body of loop, first parameter is iteration index,
+     * second is index of worker running it (in range [0, thread count))
+     */
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)> & function);
+
+private:
+
+    /**
+     * @brief Main loop of background worker
+     *
+     * @param worker index of worker
+     */
+    void workerLoop(size_t worker);
+
+    /**
+     * @brief Take and run iterations of current loop until there are none left
+     *
+     * @param function body of loop
+     * @param count number of iterations
+     * @param worker index of worker
+     */
+    void runIterations(const std::function<void(size_t, size_t)> & function, size_t count, size_t worker);
+};
+
+#endif /* THREADPOOL_H */
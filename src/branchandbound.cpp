@@ -0,0 +1,329 @@
+#include "branchandbound.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <stdexcept>
+
+// Search nodes visited between checks of time limit
+#define BRANCHANDBOUND_CLOCK_INTERVAL 1024
+
+/**
+ * @brief Position of the first interval of entry in sorted intervals of timetable
+ *
+ * Intervals are sorted by day, start and end (see ScoreEvaluator).
+ *
+ * @param problem flat model of schedules
+ * @param entry index of entry
+ * @return std::tuple<size_t, uint32_t, uint32_t> day, start and end of the first interval
+ * (largest possible if entry has none)
+ */
+static std::tuple<size_t, uint32_t, uint32_t> firstInterval(const ProblemModel & problem, size_t entry) {
+    std::tuple<size_t, uint32_t, uint32_t> result(std::numeric_limits<size_t>::max(), 0, 0);
+    for (auto & timeslot : problem.timeslots(entry)) {
+        result = std::min(result, std::make_tuple(static_cast<size_t>(timeslot.day),
+            timeslot.startTime.valueInMinutes(), timeslot.endTime.valueInMinutes()));
+    }
+    return result;
+}
+
+BranchAndBound::BranchAndBound(const Semester & s, const Priorities & p, const ExactSearchSettings & e) :
+    priorities(p),
+    settings(e),
+    genomeIndexToSchedule(s.schedulePtrs),
+    problem(),
+    occupancy(),
+    evaluator(),
+    lowerBounds(p),
+    upperBounds(p),
+    entryWords(0),
+    conflicts(),
+    entryBonuses(),
+    entryPenalties(),
+    valueOrders(),
+    searchedGenes(),
+    latestValues(),
+    seedCandidates(),
+    genome(),
+    assigned(),
+    alive(),
+    occupied(),
+    best(),
+    bestFitness(0),
+    found(false),
+    stopped(false),
+    deadline(),
+    workspace(),
+    status(SearchStatus::Infeasible),
+    nodeCount(0) {
+
+    // Flat model of schedules, shared with evolution
+    problem.reset(new ProblemModel(genomeIndexToSchedule));
+    occupancy.reset(new OccupancyModel(*problem));
+    evaluator.reset(new ScoreEvaluator(*problem, priorities));
+
+    lowerBounds.setToLowerBounds(genomeIndexToSchedule, priorities);
+    upperBounds.setToUpperBounds(genomeIndexToSchedule, priorities);
+
+    size_t geneCount = problem->getGeneCount();
+    size_t entryCount = problem->getEntryCount();
+    size_t words = occupancy->getWordCount();
+    entryWords = (entryCount + 63) / 64;
+
+    // Entries of different schedules without common bits never collide
+    conflicts.assign(entryCount * entryWords, 0);
+    for (size_t lGene = 0; lGene < geneCount; lGene++) {
+        for (size_t rGene = lGene + 1; rGene < geneCount; rGene++) {
+            for (uint32_t lValue = 0; lValue < problem->valueCount(lGene); lValue++) {
+                for (uint32_t rValue = 0; rValue < problem->valueCount(rGene); rValue++) {
+                    if (!OccupancyModel::intersects(occupancy->bitmap(lGene, lValue), occupancy->bitmap(rGene, rValue), words)) {
+                        continue;
+                    }
+
+                    size_t lEntry = problem->entryIndex(lGene, lValue);
+                    size_t rEntry = problem->entryIndex(rGene, rValue);
+                    if (problem->collisions(lEntry, rEntry) == 0) {
+                        continue;
+                    }
+                    conflicts[lEntry * entryWords + rEntry / 64] |= uint64_t(1) << (rEntry % 64);
+                    conflicts[rEntry * entryWords + lEntry / 64] |= uint64_t(1) << (lEntry % 64);
+                }
+            }
+        }
+    }
+
+    // Scores of each entry alone, bonuses and wrong start times of timetable are their sums
+    std::vector<double> entryFitness;
+    for (size_t entry = 0; entry < entryCount; entry++) {
+        bool ignored = problem->isIgnored(problem->geneOf(entry));
+        std::vector<IntervalEntry> intervals;
+        for (auto & interval : problem->timeslots(entry)) {
+            intervals.emplace_back(interval, EntryProperties { ignored, problem->bonus(entry) });
+        }
+
+        Scores scores(priorities);
+        scores.calculateScore(intervals, priorities);
+        entryBonuses.push_back(scores.isEnabled(Criterion::Bonuses) ? scores[Criterion::Bonuses] : 0);
+        entryPenalties.push_back(scores.isEnabled(Criterion::WrongStartTime) ? scores[Criterion::WrongStartTime] : 0);
+        entryFitness.push_back(scores.convertScoreToFitness(lowerBounds, upperBounds));
+    }
+
+    // Entries are tried from the best one alone, so good timetables are found early
+    for (size_t gene = 0; gene < geneCount; gene++) {
+        std::vector<uint32_t> order(problem->valueCount(gene));
+        for (uint32_t value = 0; value < order.size(); value++) {
+            order[value] = value;
+        }
+        std::stable_sort(order.begin(), order.end(), [ & ] (uint32_t lhs, uint32_t rhs) -> bool {
+            return entryFitness[problem->entryIndex(gene, lhs)] > entryFitness[problem->entryIndex(gene, rhs)];
+            });
+        valueOrders.push_back(std::move(order));
+
+        if (!problem->isIgnored(gene)) {
+            searchedGenes.push_back(gene);
+        }
+    }
+
+    // Ignored entries can only change the first consecutive run, by being the first interval of timetable.
+    // With the latest entries of other ignored genes, an entry is the first one in every timetable
+    // where some choice of ignored entries makes it first
+    latestValues.assign(geneCount, 0);
+    if (lowerBounds.isEnabled(Criterion::ManyConsecutiveHours)) {
+        for (size_t gene = 0; gene < geneCount; gene++) {
+            if (!problem->isIgnored(gene) || problem->valueCount(gene) == 0) {
+                continue;
+            }
+
+            for (uint32_t value = 1; value < problem->valueCount(gene); value++) {
+                if (firstInterval(*problem, problem->entryIndex(gene, value)) > firstInterval(*problem, problem->entryIndex(gene, latestValues[gene]))) {
+                    latestValues[gene] = value;
+                }
+            }
+
+            for (uint32_t value = 0; value < problem->valueCount(gene); value++) {
+                if (value != latestValues[gene] && !problem->timeslots(problem->entryIndex(gene, value)).empty()) {
+                    seedCandidates.emplace_back(gene, value);
+                }
+            }
+        }
+    }
+}
+
+std::vector<EvolutionResult> BranchAndBound::solve() {
+    size_t geneCount = problem->getGeneCount();
+    size_t depths = searchedGenes.size() + 1;
+
+    genome = latestValues;
+    assigned.assign(geneCount, 0);
+    alive.assign(depths * entryWords, 0);
+    occupied.assign(depths * occupancy->getWordCount(), 0);
+    found = false;
+    stopped = false;
+    bestFitness = 0;
+    nodeCount = 0;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(settings.timeLimit);
+
+    // Entries colliding with themselves can never be selected
+    for (size_t gene : searchedGenes) {
+        for (uint32_t value = 0; value < problem->valueCount(gene); value++) {
+            size_t entry = problem->entryIndex(gene, value);
+            if (problem->collisions(entry, entry) == 0) {
+                alive[entry / 64] |= uint64_t(1) << (entry % 64);
+            }
+        }
+    }
+
+    search(0, 0, 0);
+
+    if (stopped) {
+        status = SearchStatus::LimitReached;
+    } else if (found) {
+        status = SearchStatus::Optimal;
+    } else {
+        status = SearchStatus::Infeasible;
+    }
+
+    if (!found) {
+        return std::vector<EvolutionResult>();
+    }
+
+    // Convert best genome to result
+    std::vector<EvolutionResult> result;
+    for (size_t i = 0; i < geneCount; i++) {
+        std::shared_ptr<Schedule> schedule = genomeIndexToSchedule[i];
+        if (best[i] >= schedule->entriesPtrs.size()) {
+            throw std::invalid_argument("Schedule has no entries.");
+        }
+        EntryAddress address = std::make_pair(schedule->course, schedule->name);
+
+        result.emplace_back(std::make_pair(address, schedule->entriesPtrs[best[i]]));
+    }
+
+    return result;
+}
+
+SearchStatus BranchAndBound::getStatus() const {
+    return status;
+}
+
+size_t BranchAndBound::getNodeCount() const {
+    return nodeCount;
+}
+
+size_t BranchAndBound::getGenomeSize() const {
+    return problem->getGeneCount();
+}
+
+void BranchAndBound::search(size_t depth, double bonuses, double penalties) {
+    nodeCount++;
+    if ((settings.nodeLimit != 0 && nodeCount > settings.nodeLimit)
+        || (settings.timeLimit != 0 && nodeCount % BRANCHANDBOUND_CLOCK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline)) {
+        stopped = true;
+        return;
+    }
+
+    size_t words = occupancy->getWordCount();
+    const uint64_t * aliveHere = alive.data() + depth * entryWords;
+    const uint64_t * occupiedHere = occupied.data() + depth * words;
+
+    // All schedules have an entry, only scores without collisions can be reached here
+    if (depth == searchedGenes.size()) {
+        evaluate();
+        return;
+    }
+
+    // Find schedule with fewest entries left and the best entries left of each schedule
+    size_t branchGene = 0;
+    size_t branchCount = std::numeric_limits<size_t>::max();
+    double restBonuses = 0;
+    double restPenalties = 0;
+    for (size_t gene : searchedGenes) {
+        if (assigned[gene]) {
+            continue;
+        }
+
+        size_t count = 0;
+        double bonus = std::numeric_limits<double>::max();
+        double penalty = std::numeric_limits<double>::max();
+        for (uint32_t value = 0; value < problem->valueCount(gene); value++) {
+            size_t entry = problem->entryIndex(gene, value);
+            if (contains(aliveHere, entry)) {
+                count++;
+                bonus = std::min(bonus, entryBonuses[entry]);
+                penalty = std::min(penalty, entryPenalties[entry]);
+            }
+        }
+
+        if (count == 0) { // Every entry collides with selected ones
+            return;
+        }
+
+        restBonuses += bonus;
+        restPenalties += penalty;
+        if (count < branchCount) {
+            branchCount = count;
+            branchGene = gene;
+        }
+    }
+
+    // Prune if even optimistic scores can't beat the best timetable
+    if (found) {
+        Scores optimistic = lowerBounds;
+        optimistic[Criterion::Bonuses] = bonuses + restBonuses;
+        optimistic[Criterion::WrongStartTime] = penalties + restPenalties;
+        optimistic[Criterion::CoherentInWeek] = std::max<double>(occupancy->daySpan(occupiedHere), lowerBounds[Criterion::CoherentInWeek]);
+        if (optimistic.convertScoreToFitness(lowerBounds, upperBounds) <= bestFitness) {
+            return;
+        }
+    }
+
+    // Select each entry left, removing entries colliding with it
+    uint64_t * aliveNext = alive.data() + (depth + 1) * entryWords;
+    uint64_t * occupiedNext = occupied.data() + (depth + 1) * words;
+    assigned[branchGene] = true;
+    for (uint32_t value : valueOrders[branchGene]) {
+        size_t entry = problem->entryIndex(branchGene, value);
+        if (!contains(aliveHere, entry)) {
+            continue;
+        }
+
+        const uint64_t * conflictRow = conflicts.data() + entry * entryWords;
+        for (size_t i = 0; i < entryWords; i++) {
+            aliveNext[i] = aliveHere[i] & ~conflictRow[i];
+        }
+        std::copy(occupiedHere, occupiedHere + words, occupiedNext);
+        OccupancyModel::merge(occupiedNext, occupancy->bitmap(branchGene, value), words);
+
+        genome[branchGene] = value;
+        search(depth + 1, bonuses + entryBonuses[entry], penalties + entryPenalties[entry]);
+        if (stopped) {
+            break;
+        }
+    }
+    assigned[branchGene] = false;
+}
+
+void BranchAndBound::evaluate() {
+    consider();
+
+    for (auto & [ gene, value ] : seedCandidates) {
+        uint32_t latest = genome[gene];
+        genome[gene] = value;
+        consider();
+        genome[gene] = latest;
+    }
+}
+
+void BranchAndBound::consider() {
+    Scores scores = evaluator->evaluate(genome, workspace);
+    double fitness = scores.convertScoreToFitness(lowerBounds, upperBounds);
+    if (scores[Criterion::Collisions] == 0 && (!found || fitness > bestFitness)) {
+        found = true;
+        bestFitness = fitness;
+        best = genome;
+    }
+}
+
+bool BranchAndBound::contains(const uint64_t * bitset, size_t entry) {
+    return (bitset[entry / 64] >> (entry % 64)) & 1;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file branchandbound.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Exact search of timetable without collisions
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef BRANCHANDBOUND_H
+#define BRANCHANDBOUND_H
+
+#include "evolution.h"
+#include "Data/subjects.h"
+#include "Data/priorities.h"
+#include "Evolution/problem.h"
+#include "Evolution/occupancy.h"
+#include "Evolution/evaluator.h"
+#include "Evolution/scores.h"
+#include "Evolution/settings.h"
+
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Outcome of exact search
+ *
+ */
+enum class SearchStatus {
+    Optimal, //!< Best timetable without collisions was found and proven
+    Infeasible, //!< Every timetable has a collision
+    LimitReached //!< Search was stopped by limit, timetable (if any) is the best one found
+};
+
+/**
+ * @brief Exact search of the best timetable without collisions
+ *
+ * Depth-first search assigning entries to schedules, always branching on the schedule
+ * with fewest entries left (most constrained first), best entries first. Each entry has a bitset
+ * of entries colliding with it (prefiltered by occupancy bitmaps), choosing an entry removes them
+ * from the bitset of entries left, so schedules without any entry left are found at once.
+ *
+ * Timetables are compared by fitness against bounds of scores any timetable can reach
+ * (like static fitness normalisation of Evolution). Search is pruned by an optimistic
+ * estimate of scores: bonuses and wrong start times are exact sums of chosen entries
+ * and the best entries left, coherence in week is the span of chosen entries,
+ * other criteria use their lower bounds.
+ *
+ * Ignored schedules are not branched on. Their entries only matter as the very first interval
+ * of timetable, which starts the first consecutive run (like in ManyConsecutiveHoursScore).
+ * Each ignored schedule therefore keeps its entry starting as late as possible and every complete
+ * timetable is also scored with each other entry of ignored schedules, so the first interval
+ * can be any one that some timetable starts with.
+ *
+ */
+class BranchAndBound {
+
+    Priorities priorities; // Specified priorities for generation
+    ExactSearchSettings settings; // Limits of search
+
+    std::vector<std::shared_ptr<Schedule>> genomeIndexToSchedule; // Schedule of each gene
+    std::unique_ptr<ProblemModel> problem; // Flat model of schedules
+    std::unique_ptr<OccupancyModel> occupancy; // Week occupancy bitmaps of entries
+    std::unique_ptr<ScoreEvaluator> evaluator; // Calculation of scores of whole timetables
+
+    // Lowest and highest scores any timetable can reach, fitness is calculated against them
+    Scores lowerBounds;
+    Scores upperBounds;
+
+    size_t entryWords; // Words of bitset of all entries
+    std::vector<uint64_t> conflicts; // Bitset of colliding entries of each entry
+    std::vector<double> entryBonuses; // Bonuses score of each entry alone
+    std::vector<double> entryPenalties; // Wrong start times score of each entry alone
+    std::vector<std::vector<uint32_t>> valueOrders; // Entries of each gene, from the best one alone
+    std::vector<size_t> searchedGenes; // Genes that are not ignored
+    Genome latestValues; // Entry of each ignored gene starting as late as possible (zero for other genes)
+    std::vector<std::pair<size_t, uint32_t>> seedCandidates; // Entries of ignored genes that can start timetable earlier
+
+    // State of running search
+    Genome genome; // Entries selected so far
+    std::vector<uint8_t> assigned; // Whether gene has selected entry
+    std::vector<uint64_t> alive; // Entries left at each depth
+    std::vector<uint64_t> occupied; // Union of bitmaps of selected entries at each depth
+    Genome best; // Best timetable found
+    double bestFitness; // Fitness of best timetable
+    bool found; // Some timetable without collisions was found
+    bool stopped; // Limit was reached
+    std::chrono::steady_clock::time_point deadline; // End of time limit
+    ScoreEvaluator::Workspace workspace; // Workspace of scoring
+
+    SearchStatus status; // Outcome of the last search
+    size_t nodeCount; // Nodes visited by the last search
+
+public:
+
+    BranchAndBound() = delete;
+
+    /**
+     * @brief Construct a new Branch And Bound object
+     *
+     * Prepares conflicts of all pairs of entries, so memory grows with square of number of entries.
+     *
+     * @param s semester for which a timetable will be searched
+     * @param p priorities for timetable generation
+     * @param e limits of search
+     */
+    BranchAndBound(
+        const Semester & s,
+        const Priorities & p,
+        const ExactSearchSettings & e = ExactSearchSettings());
+
+    /**
+     * @brief Search the best timetable without collisions
+     *
+     * @return std::vector<EvolutionResult> best timetable (proven optimal if status is Optimal),
+     * empty if none was found
+     */
+    std::vector<EvolutionResult> solve();
+
+    /**
+     * @brief Get outcome of the last search
+     *
+     * @return SearchStatus outcome
+     */
+    SearchStatus getStatus() const;
+
+    /**
+     * @brief Get number of nodes visited by the last search
+     *
+     * @return size_t number of nodes
+     */
+    size_t getNodeCount() const;
+
+    /**
+     * @brief Get size of genome
+     *
+     * @return size_t number of schedules
+     */
+    size_t getGenomeSize() const;
+
+private:
+
+    /**
+     * @brief Search all completions of selected entries
+     *
+     * @param depth number of searched genes with selected entry
+     * @param bonuses bonuses score of selected entries
+     * @param penalties wrong start times score of selected entries
+     */
+    void search(size_t depth, double bonuses, double penalties);
+
+    /**
+     * @brief Score complete timetable with each possible first interval and keep the best one
+     *
+     * Entries of ignored genes are exchanged one at a time for those of seedCandidates.
+     */
+    void evaluate();
+
+    /**
+     * @brief Score genome and keep it if it is the best timetable without collisions
+     */
+    void consider();
+
+    /**
+     * @brief Check if entry is in bitset
+     *
+     * @param bitset bitset of entries
+     * @param entry index of entry
+     * @return true entry is in bitset
+     */
+    static bool contains(const uint64_t * bitset, size_t entry);
+};
+
+#endif /* BRANCHANDBOUND_H */
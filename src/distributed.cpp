@@ -0,0 +1,384 @@
+#include "distributed.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief Types of messages between coordinator and workers
+ *
+ */
+enum MessageType : uint8_t {
+    MigrantsMessage, // Worker sends its emigrants, coordinator replies with migrants for the worker
+    ProgressMessage, // Worker starts a generation (only the first island)
+    ResultMessage, // Worker sends its best genome and ends
+    FailureMessage // Worker failed, payload is description of the error
+};
+
+// Little endian encoding of numbers in messages
+
+static void writeNumber(std::vector<uint8_t> & data, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static uint64_t readNumber(const std::vector<uint8_t> & data, size_t & position, size_t bytes) {
+    if (data.size() - position < bytes) {
+        throw std::runtime_error("Message is too short.");
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= uint64_t(data[position + i]) << (8 * i);
+    }
+    position += bytes;
+    return value;
+}
+
+ProcessIslandEvolution::ProcessIslandEvolution(const Semester & s, const Priorities & p, std::function<void(size_t, size_t)> proc,
+    const EvolutionSettings & e, const IslandSettings & i) :
+    semester(s),
+    priorities(p),
+    settings(e),
+    islandSettings(i),
+    processCount(i.islandCount),
+    valueCounts(),
+    criteria(Scores::enabledCriteria(p)),
+    converter(),
+    processing(proc) {
+
+    if (processCount == 0) {
+        processCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (auto & schedule : semester.schedulePtrs) {
+        valueCounts.push_back(schedule->entriesPtrs.size());
+    }
+
+    settings.threadCount = 1;
+    converter.reset(new Evolution(semester, priorities, nullptr, settings));
+}
+
+std::vector<EvolutionResult> ProcessIslandEvolution::evolve(size_t generationSize, size_t maxGenerations) {
+
+    if (generationSize == 0 || maxGenerations == 0) {
+        throw std::invalid_argument("Generation counts can't be zero.");
+    }
+
+    std::vector<std::unique_ptr<MessageChannel>> channels; // Connection to each worker
+    std::vector<pid_t> workers; // Process of each worker
+
+    // Stop and reap all started workers
+    auto stopWorkers = [ & ] (int signal) {
+        channels.clear();
+        for (pid_t worker : workers) {
+            if (signal != 0) {
+                ::kill(worker, signal);
+            }
+            while (::waitpid(worker, nullptr, 0) < 0 && errno == EINTR) { }
+        }
+        workers.clear();
+        };
+
+    // Buffered output would be written by every worker again
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    try {
+        for (size_t island = 0; island < processCount; island++) {
+            std::pair<int, int> sockets = MessageChannel::createSocketPair();
+
+            pid_t worker = ::fork();
+            if (worker < 0) {
+                int error = errno;
+                ::close(sockets.first);
+                ::close(sockets.second);
+                throw std::system_error(error, std::generic_category(), "Unable to start worker process");
+            }
+
+            if (worker == 0) {
+                // Worker keeps only its own socket, so coordinator sees when any worker ends
+                channels.clear();
+                ::close(sockets.first);
+
+                int status = EXIT_SUCCESS;
+                try {
+                    MessageChannel channel(sockets.second);
+                    runWorker(channel, island, generationSize, maxGenerations);
+                }
+                catch (...) {
+                    status = EXIT_FAILURE;
+                }
+                ::_exit(status); // Worker must not return to the caller of coordinator
+            }
+
+            ::close(sockets.second);
+            channels.emplace_back(new MessageChannel(sockets.first));
+            workers.push_back(worker);
+        }
+    }
+    catch (...) {
+        stopWorkers(SIGKILL);
+        throw;
+    }
+
+    std::vector<std::optional<Migrant>> bests(processCount); // Result of each worker
+    std::vector<std::vector<uint8_t>> mailboxes(processCount); // Latest undelivered migrants for each worker
+    std::vector<Random> randoms;
+    for (size_t island = 0; island < processCount; island++) {
+        randoms.emplace_back(settings.seed, island + 1, 0);
+    }
+
+    try {
+        size_t running = processCount;
+        while (running > 0) {
+            std::vector<pollfd> descriptors;
+            std::vector<size_t> islands;
+            for (size_t island = 0; island < processCount; island++) {
+                if (!bests[island].has_value()) {
+                    descriptors.push_back({ channels[island]->getDescriptor(), POLLIN, 0 });
+                    islands.push_back(island);
+                }
+            }
+
+            if (::poll(descriptors.data(), descriptors.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "Unable to wait for workers");
+            }
+
+            for (size_t i = 0; i < descriptors.size(); i++) {
+                if (descriptors[i].revents == 0) {
+                    continue;
+                }
+
+                size_t island = islands[i];
+                MessageChannel & channel = *channels[island];
+                channel.fill();
+
+                std::optional<Message> message;
+                while (!bests[island].has_value() && (message = channel.next()).has_value()) {
+                    switch (message->type) {
+                        case MigrantsMessage: {
+                            // Deliver waiting migrants as reply, the worker reads it on its next migration
+                            try {
+                                channel.send(MigrantsMessage, mailboxes[island]);
+                            }
+                            catch (const std::system_error &) {
+                                // Worker already ended after its last migration, its result is still to be read
+                            }
+                            mailboxes[island].clear();
+
+                            size_t target = IslandEvolution::destination(islandSettings.topology, island, processCount, randoms[island]);
+                            mailboxes[target] = std::move(message->payload);
+                            break;
+                        }
+                        case ProgressMessage: {
+                            size_t position = 0;
+                            size_t generation = readNumber(message->payload, position, 8);
+                            if (island == 0 && processing != nullptr) {
+                                processing(generation, maxGenerations);
+                            }
+                            break;
+                        }
+                        case ResultMessage: {
+                            std::vector<Migrant> best = deserialize(message->payload);
+                            if (best.size() != 1) {
+                                throw std::runtime_error("Worker sent malformed result.");
+                            }
+                            bests[island] = std::move(best.front());
+                            running--;
+                            break;
+                        }
+                        case FailureMessage:
+                            throw std::runtime_error("Worker failed: " + std::string(message->payload.begin(), message->payload.end()));
+                        default:
+                            throw std::runtime_error("Worker sent unknown message.");
+                    }
+                }
+
+                if (!bests[island].has_value() && channel.isClosed()) {
+                    throw std::runtime_error("Worker ended without result.");
+                }
+            }
+        }
+    }
+    catch (...) {
+        stopWorkers(SIGKILL);
+        throw;
+    }
+
+    stopWorkers(0);
+
+    std::vector<Scores> scores;
+    for (auto & best : bests) {
+        scores.push_back(best->scores);
+    }
+
+    return converter->timetable(bests[IslandEvolution::bestOf(scores)]->genome);
+}
+
+size_t ProcessIslandEvolution::getGenomeSize() const {
+    return converter->getGenomeSize();
+}
+
+size_t ProcessIslandEvolution::getProcessCount() const {
+    return processCount;
+}
+
+std::vector<uint8_t> ProcessIslandEvolution::serialize(const std::vector<Migrant> & migrants) {
+    std::vector<uint8_t> result;
+    writeNumber(result, migrants.size(), 4);
+
+    for (auto & migrant : migrants) {
+        uint32_t maxGene = 0;
+        for (uint32_t gene : migrant.genome) {
+            maxGene = std::max(maxGene, gene);
+        }
+        size_t width = GeneMatrix::widthFor(size_t(maxGene) + 1);
+
+        writeNumber(result, migrant.genome.size(), 4);
+        writeNumber(result, width, 1);
+        for (uint32_t gene : migrant.genome) {
+            writeNumber(result, gene, width);
+        }
+
+        writeNumber(result, migrant.scores.enabled, 4);
+        for (size_t c = 0; c < CRITERIA_COUNT; c++) {
+            if (migrant.scores.isEnabled(static_cast<Criterion>(c))) {
+                writeNumber(result, std::bit_cast<uint64_t>(migrant.scores.values[c]), 8);
+            }
+        }
+    }
+
+    return result;
+}
+
+std::vector<Migrant> ProcessIslandEvolution::deserialize(const std::vector<uint8_t> & data) const {
+    size_t position = 0;
+    size_t count = readNumber(data, position, 4);
+
+    std::vector<Migrant> result;
+    for (size_t i = 0; i < count; i++) {
+        size_t geneCount = readNumber(data, position, 4);
+        if (geneCount != valueCounts.size()) {
+            throw std::runtime_error("Message has wrong number of genes.");
+        }
+        size_t width = readNumber(data, position, 1);
+        if (width != 1 && width != 2 && width != 4) {
+            throw std::runtime_error("Message has wrong width of genes.");
+        }
+        if ((data.size() - position) / width < geneCount) {
+            throw std::runtime_error("Message is too short.");
+        }
+
+        Genome genome(geneCount);
+        for (size_t gene = 0; gene < geneCount; gene++) {
+            genome[gene] = static_cast<uint32_t>(readNumber(data, position, width));
+            if (genome[gene] >= valueCounts[gene]) {
+                throw std::runtime_error("Message has gene out of range.");
+            }
+        }
+
+        if (readNumber(data, position, 4) != criteria) {
+            throw std::runtime_error("Message has wrong criteria.");
+        }
+        Scores scores(criteria);
+        for (size_t c = 0; c < CRITERIA_COUNT; c++) {
+            if (scores.isEnabled(static_cast<Criterion>(c))) {
+                scores.values[c] = std::bit_cast<double>(readNumber(data, position, 8));
+            }
+        }
+
+        result.push_back(Migrant { std::move(genome), scores });
+    }
+
+    if (position != data.size()) {
+        throw std::runtime_error("Message is too long.");
+    }
+
+    return result;
+}
+
+void ProcessIslandEvolution::runWorker(MessageChannel & channel, size_t island, size_t generationSize, size_t maxGenerations) const {
+
+    /**
+     * @brief Link of island to coordinator
+     *
+     */
+    struct SocketLink : MigrationLink {
+        MessageChannel & channel;
+        const ProcessIslandEvolution & owner;
+
+        SocketLink(MessageChannel & c, const ProcessIslandEvolution & o) : channel(c), owner(o) { }
+
+        void send(std::vector<Migrant> migrants) override {
+            channel.send(MigrantsMessage, serialize(migrants));
+        }
+
+        std::vector<Migrant> receive() override {
+            // Only the latest batch is kept, like in mailbox of threads
+            channel.fill();
+            std::vector<Migrant> result;
+            while (std::optional<Message> message = channel.next()) {
+                if (message->type != MigrantsMessage) {
+                    throw std::runtime_error("Coordinator sent unknown message.");
+                }
+                if (!message->payload.empty()) {
+                    result = owner.deserialize(message->payload);
+                }
+            }
+            return result;
+        }
+    };
+
+    try {
+        // Same seeds as islands on threads
+        EvolutionSettings islandEvolutionSettings = settings;
+        Random seeds(settings.seed);
+        for (size_t i = 0; i <= island; i++) {
+            islandEvolutionSettings.seed = seeds.next();
+        }
+
+        IslandSettings islandModelSettings = islandSettings;
+        if (processCount < 2) {
+            islandModelSettings.migrationInterval = 0;
+        }
+
+        std::function<void(size_t, size_t)> progress = nullptr;
+        if (island == 0) {
+            progress = [ & ] (size_t value, size_t) {
+                std::vector<uint8_t> payload;
+                writeNumber(payload, value, 8);
+                channel.send(ProgressMessage, payload);
+                };
+        }
+
+        Evolution evolution(semester, priorities, nullptr, islandEvolutionSettings);
+        SocketLink link(channel, *this);
+
+        EvolutionState state = evolution.start(generationSize);
+        IslandEvolution::runIsland(evolution, state, maxGenerations, islandModelSettings, link, progress);
+
+        channel.send(ResultMessage, serialize(evolution.emigrants(state, 1)));
+    }
+    catch (const std::exception & e) {
+        std::string description = e.what();
+        channel.send(FailureMessage, std::vector<uint8_t>(description.begin(), description.end()));
+        throw;
+    }
+}
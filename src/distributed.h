@@ -0,0 +1,143 @@
+/**
+ * @file distributed.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Island model of evolution across processes
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include "evolution.h"
+#include "islands.h"
+#include "Evolution/settings.h"
+#include "Utility/channel.h"
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+/**
+ * @brief Evolution on islands, each in its own worker process
+ *
+ * The calling process is the coordinator. It forks one worker process for each island,
+ * connected by a Unix domain socket pair. Workers send their best genomes to coordinator
+ * every migration interval and coordinator keeps them for the receiving island (see IslandSettings),
+ * which gets the latest batch as reply to its next migration. Coordinator therefore never waits
+ * for a worker to read. At the end, each worker sends its best genome and exits,
+ * coordinator returns the best of them.
+ *
+ * Migrants are sent as compact binary messages, so the protocol works over any stream socket
+ * and does not depend on shared memory.
+ *
+ * Like with IslandEvolution, received migrants depend on timing of processes.
+ *
+ */
+class ProcessIslandEvolution {
+
+    Semester semester; // Semester to generate timetable for
+    Priorities priorities; // Specified priorities for generation
+
+    EvolutionSettings settings; // Settings of evolution on each island
+    IslandSettings islandSettings; // Settings of island model
+    size_t processCount; // Number of worker processes
+
+    std::vector<size_t> valueCounts; // Number of entries of each schedule, for checking received genomes
+    CriteriaMask criteria; // Criteria of received scores
+
+    std::unique_ptr<Evolution> converter; // Conversion of genomes to timetables (runs nothing)
+
+    std::function<void(size_t, size_t)> processing; // Function to be called after every generation of the first island
+
+public:
+
+    ProcessIslandEvolution() = delete;
+
+    /**
+     * @brief Construct a new Process Island Evolution object
+     *
+     * @param s semester for which a timetable will be generated
+     * @param p priorities for timetable generation
+     * @param proc function to be called after every generation of the first island (in coordinator),
+     * where first parameter is current progress value, second is max value
+     * @param e settings of evolution on each island (thread count is ignored, each worker runs on one thread)
+     * @param i settings of island model, island count is the number of worker processes
+     */
+    ProcessIslandEvolution(
+        const Semester & s,
+        const Priorities & p,
+        std::function<void(size_t, size_t)> proc = nullptr,
+        const EvolutionSettings & e = EvolutionSettings(),
+        const IslandSettings & i = IslandSettings());
+
+    /**
+     * @brief Generate timetable using genetic algorithm in worker processes
+     *
+     * Has to be called from a process without other running threads (workers are forked).
+     *
+     * @throws std::invalid_argument generation size or number of generations is zero
+     * @throws std::system_error if processes or sockets can't be created
+     * @throws std::runtime_error if a worker fails
+     *
+     * @param generationSize size of generation of each island
+     * @param maxGenerations number of generations of each island
+     * @return std::vector<EvolutionResult> best timetable of all islands
+     */
+    std::vector<EvolutionResult> evolve(size_t generationSize = 100, size_t maxGenerations = 100);
+
+    /**
+     * @brief Get size of genome
+     *
+     * @return size_t size of genome
+     */
+    size_t getGenomeSize() const;
+
+    /**
+     * @brief Get number of worker processes
+     *
+     * @return size_t number of processes
+     */
+    size_t getProcessCount() const;
+
+    /**
+     * @brief Serialize migrants into compact binary form
+     *
+     * Count of migrants, then for each migrant count of genes, bytes of one gene (1, 2 or 4),
+     * genes, mask of enabled criteria and value of each enabled criterion.
+     * All numbers are little endian.
+     *
+     * @param migrants migrants
+     * @return std::vector<uint8_t> serialized migrants
+     */
+    static std::vector<uint8_t> serialize(const std::vector<Migrant> & migrants);
+
+    /**
+     * @brief Deserialize migrants of this evolution
+     *
+     * @throws std::runtime_error if data are malformed or genomes and scores do not belong
+     * to the semester and priorities of this evolution
+     *
+     * @param data serialized migrants
+     * @return std::vector<Migrant> migrants
+     */
+    std::vector<Migrant> deserialize(const std::vector<uint8_t> & data) const;
+
+private:
+
+    /**
+     * @brief Run island in worker process
+     *
+     * @param channel connection to coordinator
+     * @param island index of island
+     * @param generationSize size of generation
+     * @param maxGenerations number of generations
+     */
+    void runWorker(MessageChannel & channel, size_t island, size_t generationSize, size_t maxGenerations) const;
+};
+
+#endif /* DISTRIBUTED_H */
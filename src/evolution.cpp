@@ -1,5 +1,9 @@
 #include "evolution.h"
 
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
 // For each N genes a new k-point crossover divider to be created
 #define EVOLUTION_POINT_CROSSOVER_DIVIDER 10
 
@@ -9,14 +13,35 @@
 // For each N genes a mutation should be called again
 #define EVOLUTION_MUTATION_DIVIDER 25
 
-Evolution::Evolution(const Semester & s, const Priorities & p, std::function<void(size_t, size_t)> proc) :
+// Number of genomes created or scored by one parallel task,
+// each block of offsprings has its own random stream, so it must not depend on thread count
+#define EVOLUTION_PARALLEL_BLOCK_SIZE 64
+
+Evolution::Evolution(const Semester & s, const Priorities & p, std::function<void(size_t, size_t)> proc,
+    const EvolutionSettings & e) :
     semester(s),
     priorities(p),
     genomeSize(0),
     genomeIndexToSchedule(),
     courseAndScheduleToGenomeIndex(),
     crossovers(),
-    processing(proc) {
+    parentSelection(),
+    settings(e),
+    criteria(Scores::enabledCriteria(p)),
+    lowerBounds(criteria),
+    upperBounds(criteria),
+    problem(),
+    geneWidth(0),
+    genomeHasher(),
+    evaluator(),
+    fitnessCache(new FitnessCache(e.cacheSize)),
+    localSearchScorers(),
+    localSearchGenomes(),
+    threadPool(new ThreadPool(e.threadCount)),
+    arenas(new WorkerArenas(threadPool->getThreadCount())),
+    processing(proc),
+    stopReason(StopReason::None),
+    generationCount(0) {
 
     // Copy all schedules from semester for easier conversion from genome index
     genomeIndexToSchedule = s.schedulePtrs;
@@ -32,193 +57,734 @@ Evolution::Evolution(const Semester & s, const Priorities & p, std::function<voi
     }
     genomeSize = i;
 
+    // Compile schedules into flat model used during evolution
+    problem.reset(new ProblemModel(genomeIndexToSchedule));
+
+    // Create hashing of genomes, each gene has as many values as entries in its schedule
+    std::vector<size_t> valueCounts;
+    for (size_t gene = 0; gene < genomeSize; gene++) {
+        valueCounts.push_back(problem->valueCount(gene));
+    }
+    genomeHasher.reset(new GenomeHasher(valueCounts, settings.seed));
+
+    // Genes of population are stored in the narrowest type able to index entries of every schedule
+    size_t maxValueCount = 0;
+    for (size_t count : valueCounts) {
+        maxValueCount = std::max(maxValueCount, count);
+    }
+    geneWidth = GeneMatrix::widthFor(maxValueCount);
+
+    // Calculation of scores over flat model
+    evaluator.reset(new ScoreEvaluator(*problem, priorities));
+
     // Generate all crossover operators
     crossovers.emplace_back(new UniformCrossover());
     crossovers.emplace_back(new PointCrossover(1));
     for (size_t i = 2; i <= (genomeSize / EVOLUTION_POINT_CROSSOVER_DIVIDER); i++) { // Generate k-point crossovers based on genome size
         crossovers.emplace_back(new PointCrossover(i));
     }
+
+    // Calculate bounds of scores, for fitness that does not depend on generation
+    if (settings.fitnessNormalisation == FitnessNormalisation::Static) {
+        lowerBounds.setToLowerBounds(genomeIndexToSchedule, priorities);
+        upperBounds.setToUpperBounds(genomeIndexToSchedule, priorities);
+    } else if (settings.stopAtLowerBounds) { // Lower bounds are also the target of evolution
+        lowerBounds.setToLowerBounds(genomeIndexToSchedule, priorities);
+    }
+
+    // Local search scores changes of genes incrementally, each worker has its own scorer
+    if (settings.localSearchElites != 0) {
+        for (size_t worker = 0; worker < threadPool->getThreadCount(); worker++) {
+            localSearchScorers.emplace_back(new IncrementalScorer(*problem, priorities));
+        }
+        localSearchGenomes.resize(threadPool->getThreadCount(), Genome(genomeSize));
+    }
+
+    // Create parent selection operator
+    switch (settings.parentSelection) {
+        case ParentSelectionType::Uniform:
+            parentSelection.reset(new UniformSelection());
+            break;
+        case ParentSelectionType::Tournament:
+            parentSelection.reset(new TournamentSelection(settings.tournamentSize));
+            break;
+        case ParentSelectionType::Rank:
+            parentSelection.reset(new RankSelection());
+            break;
+        case ParentSelectionType::Truncation:
+            parentSelection.reset(new TruncationSelection(settings.truncationRatio));
+            break;
+    }
 }
 
-std::vector<EvolutionResult> Evolution::evolve(size_t generationSize, size_t maxGenerations) {
+std::vector<EvolutionResult> Evolution::evolve(size_t generationSize, size_t maxGenerations, std::stop_token stopToken) {
 
-    if (generationSize == 0 || maxGenerations == 0) {
+    if (maxGenerations == 0) {
         throw std::invalid_argument("Generation counts can't be zero.");
     }
 
-    std::vector<Genome> currentGeneration = createInitialGenerations(generationSize);
+    EvolutionState state = start(generationSize);
+    state.stopToken = stopToken;
+    while (state.generation < maxGenerations && state.stopReason == StopReason::None) { // Iterate through generations
+
+        if (processing != nullptr) {
+            processing(state.generation, maxGenerations);
+        }
+
+        step(state);
+    }
+
+    if (state.stopReason == StopReason::None) {
+        state.stopReason = StopReason::GenerationLimit;
+    }
+    stopReason = state.stopReason;
+    generationCount = state.generation;
+
+    return result(state);
+}
+
+std::vector<EvolutionResult> Evolution::evolveUntil(size_t generationSize, size_t maxGenerations,
+    std::chrono::steady_clock::time_point deadline,
+    const std::function<void(const std::vector<EvolutionResult> &, const Scores &)> & improved, std::stop_token stopToken) {
 
-    for (size_t gen = 0; gen < maxGenerations; gen++) { // Iterate through generations
+    if (maxGenerations == 0) {
+        throw std::invalid_argument("Generation counts can't be zero.");
+    }
 
+    EvolutionState state = start(generationSize);
+    state.deadline = deadline;
+    state.stopToken = stopToken;
+
+    // Best timetable found so far, generation may lose it later
+    Genome best(genomeSize);
+    Scores bestScores = state.currentGeneration.scores[state.bestRow];
+    auto keepBest = [ & ] () {
+        state.currentGeneration.genes.load(state.bestRow, best);
+        bestScores = state.currentGeneration.scores[state.bestRow];
+        if (improved != nullptr) {
+            improved(timetable(best), bestScores);
+        }
+        };
+    keepBest();
+
+    while (state.generation < maxGenerations && state.stopReason == StopReason::None) {
         if (processing != nullptr) {
-            processing(gen, maxGenerations);
+            processing(state.generation, maxGenerations);
+        }
+
+        // Interrupted step creates no generation, its best timetable was already passed
+        size_t generation = state.generation;
+        step(state);
+        if (state.generation != generation && state.lastImprovement == state.generation) {
+            keepBest();
         }
+    }
+
+    if (state.stopReason == StopReason::None) {
+        state.stopReason = StopReason::GenerationLimit;
+    }
+    stopReason = state.stopReason;
+    generationCount = state.generation;
+
+    return timetable(best);
+}
 
-        // Create new generation of size generation size * generation size
-        std::vector<Genome> newGeneration;
-        while (newGeneration.size() < generationSize * generationSize) {
+EvolutionState Evolution::start(size_t generationSize) {
 
-            // Randomly select parents
-            size_t lParentIndex = randomNumber(generationSize);
-            size_t rParentIndex = randomNumber(generationSize);
+    if (generationSize == 0) {
+        throw std::invalid_argument("Generation counts can't be zero.");
+    }
 
-            // Perform random crossover
-            size_t crossoverIndex = randomNumber(crossovers.size());
-            Crossover * crossover = crossovers[crossoverIndex].get();
-            Genome child = crossover->perform(currentGeneration[lParentIndex], currentGeneration[rParentIndex]);
+    // Generations are double buffered, the next one is filled by survivors and then swapped
+    EvolutionState state {
+        Population(generationSize, genomeSize, geneWidth, criteria),
+        Population(generationSize, genomeSize, geneWidth, criteria),
+        0,
+        0,
+        generationSize * generationSize,
+        0,
+        Scores(criteria),
+        Scores(criteria),
+        std::vector<double>(),
+        0,
+        1,
+        0,
+        StopReason::None,
+        std::chrono::steady_clock::time_point::max(),
+        std::stop_token()
+    };
+    if (settings.offspringMultiplier != 0) {
+        state.offspringCount = generationSize * settings.offspringMultiplier;
+    }
 
-            // Perform mutations
-            mutate(child);
-            for (size_t i = 1; i <= (genomeSize / EVOLUTION_MUTATION_DIVIDER); i++) {
-                mutate(child);
+    // Create initial generation and rank it by fitness, parent selection and elitism rely on it
+    Random initialRandom(settings.seed, 0, 0);
+    createInitialGeneration(state.currentGeneration, initialRandom);
+    selection(state.currentGeneration);
+
+    state.eliteSize = std::min((generationSize / 10) + 1, state.currentGeneration.size());
+
+    // Quality of timetables is measured against initial generation, so it can be compared between generations
+    const Population & initial = state.currentGeneration;
+    state.referenceMin = initial.scores[initial.rowOf(0)];
+    state.referenceMax = initial.scores[initial.rowOf(0)];
+    for (size_t row : initial.ranking) {
+        state.referenceMin.setToMinValuesFrom(initial.scores[row]);
+        state.referenceMax.setToMaxValuesFrom(initial.scores[row]);
+    }
+    updateConvergence(state);
+    arenas->reset();
+
+    return state;
+}
+
+void Evolution::step(EvolutionState & state) {
+
+    // Run interrupted between generations keeps its generation
+    StopReason interrupted = interruption(state);
+    if (interrupted != StopReason::None) {
+        state.stopReason = interrupted;
+        return;
+    }
+
+    Population & currentGeneration = state.currentGeneration;
+    parentSelection->prepare(currentGeneration.size());
+
+    // Fitness is calculated relative to scores reached by current generation (or to static bounds),
+    // so every offspring can be judged as soon as it is scored
+    auto [ minValues, maxValues ] = fitnessBounds(currentGeneration);
+
+    // Only genomes that belong to the next generation are kept,
+    // pool is created on the calling thread, which is worker zero
+    SurvivorPool pool(state.nextGeneration, arenas->forWorker(0));
+
+    // Add elite (best genomes) from current generation, they keep their scores
+    for (size_t i = 0; i < state.eliteSize; i++) {
+        size_t row = currentGeneration.rowOf(i);
+        double fitness = currentGeneration.scores[row].convertScoreToFitness(minValues, maxValues);
+        pool.offer(currentGeneration, row, fitness, i);
+    }
+
+    // Create and score offsprings in parallel blocks,
+    // each block has random stream given by generation and block
+    // (if the run is interrupted, no more offsprings are created)
+    bool interruptible = state.deadline != std::chrono::steady_clock::time_point::max() || state.stopToken.stop_possible();
+    std::atomic<bool> expired(false);
+    std::atomic<size_t> created(0);
+    size_t blockCount = (state.offspringCount + EVOLUTION_PARALLEL_BLOCK_SIZE - 1) / EVOLUTION_PARALLEL_BLOCK_SIZE;
+    threadPool->parallelFor(blockCount, [ & ] (size_t block, size_t worker) {
+        Random random(settings.seed, state.generation + 1, block);
+        OffspringBuffers buffers = allocateOffspringBuffers(arenas->forWorker(worker));
+        size_t blockStart = block * EVOLUTION_PARALLEL_BLOCK_SIZE;
+        size_t blockEnd = std::min((block + 1) * EVOLUTION_PARALLEL_BLOCK_SIZE, state.offspringCount);
+        size_t i = blockStart;
+        for (; i < blockEnd; i++) {
+            if (interruptible && (expired.load(std::memory_order_relaxed) || interruption(state) != StopReason::None)) {
+                expired.store(true, std::memory_order_relaxed);
+                break;
             }
 
-            newGeneration.emplace_back(child);
+            uint64_t childHash;
+            createOffspring(currentGeneration, buffers, random, childHash);
+            Scores childScores = cachedScore(buffers.child, childHash);
+            pool.offer(buffers.child, childHash, childScores, childScores.convertScoreToFitness(minValues, maxValues), state.eliteSize + i);
         }
+        created.fetch_add(i - blockStart, std::memory_order_relaxed);
+        });
+    state.evaluations += created.load();
 
-        // Add elite (best genomes) from current generation to new generation
-        size_t eliteSize = (generationSize / 10) + 1;
-        for (size_t i = 0; i < eliteSize; i++) {
-            newGeneration.push_back(currentGeneration[i]);
-        }
+    // Survivors are in their rows, everything else created during generation is freed at once
+    pool.rank();
+    std::swap(state.currentGeneration, state.nextGeneration);
+    state.generation++;
 
-        // Perform selection of generation size based on fitness of genomes
-        selection(newGeneration, generationSize);
-        currentGeneration = newGeneration;
+    localSearch(state);
+    updateConvergence(state);
+    if (expired.load()) {
+        state.stopReason = interruption(state);
     }
+    arenas->reset();
+}
+
+GenerationStatistics Evolution::statistics(const EvolutionState & state) const {
+    const Population & generation = state.currentGeneration;
+
+    // Mean fitness of generation against initial generation, like quality
+    double qualitySum = 0;
+    for (size_t row : generation.ranking) {
+        qualitySum += generation.scores[row].convertScoreToFitness(state.referenceMin, state.referenceMax);
+    }
+
+    GenerationStatistics result {
+        state.generation,
+        state.evaluations,
+        generation.scores[generation.rowOf(0)],
+        state.bestQualities.back(),
+        qualitySum / generation.size(),
+        diversity(generation),
+        state.stopReason
+    };
 
-    // Retrieve best genome of last generation
-    Genome best = currentGeneration.front();
+    return result;
+}
+
+std::vector<EvolutionResult> Evolution::result(const EvolutionState & state) const {
+
+    // Retrieve best genome of current generation
+    Genome best(genomeSize);
+    state.currentGeneration.genes.load(state.currentGeneration.rowOf(0), best);
+
+    return timetable(best);
+}
+
+std::vector<EvolutionResult> Evolution::timetable(GenomeView genome) const {
+    if (genome.size() != genomeSize) {
+        throw std::invalid_argument("Genome has different size.");
+    }
 
     // Convert genome to result
     std::vector<EvolutionResult> result;
     for (size_t i = 0; i < genomeSize; i++) {
         std::shared_ptr<Schedule> schedule = genomeIndexToSchedule[i];
+        if (genome[i] >= schedule->entriesPtrs.size()) {
+            throw std::invalid_argument("Genome has value out of range.");
+        }
         EntryAddress address = std::make_pair(schedule->course, schedule->name);
 
-        result.emplace_back(std::make_pair(address, schedule->entriesPtrs[best[i]]));
+        result.emplace_back(std::make_pair(address, schedule->entriesPtrs[genome[i]]));
     }
 
     return result;
 }
 
+std::vector<Migrant> Evolution::emigrants(const EvolutionState & state, size_t count) const {
+    const Population & generation = state.currentGeneration;
+
+    std::vector<Migrant> result;
+    for (size_t i = 0; i < std::min(count, generation.size()); i++) {
+        size_t row = generation.rowOf(i);
+        Migrant migrant { Genome(genomeSize), generation.scores[row] };
+        generation.genes.load(row, migrant.genome);
+        result.push_back(std::move(migrant));
+    }
+
+    return result;
+}
+
+void Evolution::immigrate(EvolutionState & state, const std::vector<Migrant> & migrants) {
+    Population & generation = state.currentGeneration;
+    if (migrants.empty() || generation.size() == 0) {
+        return;
+    }
+
+    // Check all migrants before generation is changed
+    for (auto & migrant : migrants) {
+        if (migrant.genome.size() != genomeSize || migrant.scores.enabled != criteria) {
+            throw std::invalid_argument("Migrant comes from different evolution.");
+        }
+        for (size_t gene = 0; gene < genomeSize; gene++) {
+            if (migrant.genome[gene] >= problem->valueCount(gene)) {
+                throw std::invalid_argument("Migrant has value out of range.");
+            }
+        }
+    }
+
+    // Migrants replace the worst genomes, elite is never replaced
+    size_t replaceable = generation.size() - std::min(state.eliteSize, generation.size());
+    size_t count = std::min(migrants.size(), replaceable);
+    for (size_t i = 0; i < count; i++) {
+        size_t row = generation.rowOf(generation.size() - 1 - i);
+        const Migrant & migrant = migrants[i];
+        generation.genes.store(row, migrant.genome);
+        generation.hashes[row] = genomeHasher->hash(migrant.genome);
+        generation.scores[row] = migrant.scores;
+    }
+
+    rerank(generation);
+}
+
 size_t Evolution::getGenomeSize() const {
     return genomeSize;
 }
 
-void Evolution::selection(std::vector<Genome> & newGeneration, size_t generationSize) const {
+CacheStatistics Evolution::getCacheStatistics() const {
+    return fitnessCache->getStatistics();
+}
+
+StopReason Evolution::getStopReason() const {
+    return stopReason;
+}
+
+size_t Evolution::getGenerationCount() const {
+    return generationCount;
+}
+
+ArenaStatistics Evolution::getArenaStatistics() const {
+    return arenas->getStatistics();
+}
+
+Evolution::OffspringBuffers Evolution::allocateOffspringBuffers(Arena & arena) const {
+    return OffspringBuffers {
+        arena.allocateArray<uint32_t>(genomeSize),
+        arena.allocateArray<uint32_t>(genomeSize),
+        arena.allocateArray<uint32_t>(genomeSize)
+    };
+}
+
+void Evolution::createOffspring(const Population & current, const OffspringBuffers & buffers, Random & random, uint64_t & hash) const {
+
+    // Select parents, selection picks ranks, which are mapped to rows
+    size_t lParentRow = current.rowOf(parentSelection->select(random));
+    size_t rParentRow = current.rowOf(parentSelection->select(random));
+
+    // Widen parents
+    current.genes.load(lParentRow, buffers.lParent);
+    current.genes.load(rParentRow, buffers.rParent);
 
-    // Keep track of maximum and minimum of reached scores
-    Scores minValues(priorities);
-    Scores maxValues(priorities);
+    // Perform random crossover
+    size_t crossoverIndex = random.below(crossovers.size());
+    Crossover * crossover = crossovers[crossoverIndex].get();
+    crossover->perform(buffers.lParent, buffers.rParent, buffers.child, random);
 
-    // Iterate through all genomes
-    bool first = true;
-    std::vector<std::pair<Genome, Scores>> scoredGenomes;
-    for (auto it = newGeneration.begin(); it != newGeneration.end(); it++) {
-        // Calculate their score
-        Scores itScore = score(*it);
-        scoredGenomes.emplace_back(std::make_pair(*it, itScore));
+    // Derive hash of child from hash of parent
+    hash = genomeHasher->update(current.hashes[lParentRow], buffers.lParent, buffers.child);
 
-        if (first) { // Adjust min and max values on first run
-            minValues = itScore;
-            maxValues = itScore;
-            first = false;
-            continue;
+    // Perform mutations
+    mutate(buffers.child, hash, random);
+}
+
+std::pair<Scores, Scores> Evolution::fitnessBounds(const Population & generation) const {
+    Scores minValues = lowerBounds;
+    Scores maxValues = upperBounds;
+    if (settings.fitnessNormalisation == FitnessNormalisation::Population && generation.size() != 0) {
+        minValues = generation.scores[generation.rowOf(0)];
+        maxValues = generation.scores[generation.rowOf(0)];
+        for (size_t row : generation.ranking) {
+            minValues.setToMinValuesFrom(generation.scores[row]);
+            maxValues.setToMaxValuesFrom(generation.scores[row]);
         }
+    }
 
-        // Calculate min and max score values
-        minValues.setToMinValuesFrom(itScore);
-        maxValues.setToMaxValuesFrom(itScore);
+    return std::make_pair(minValues, maxValues);
+}
+
+void Evolution::updateConvergence(EvolutionState & state) const {
+    const Population & generation = state.currentGeneration;
+
+    // Best quality of generation, genome ranked first need not be the best against initial generation
+    state.bestRow = generation.rowOf(0);
+    double quality = generation.scores[state.bestRow].convertScoreToFitness(state.referenceMin, state.referenceMax);
+    for (size_t row : generation.ranking) {
+        double rowQuality = generation.scores[row].convertScoreToFitness(state.referenceMin, state.referenceMax);
+        if (rowQuality > quality) {
+            quality = rowQuality;
+            state.bestRow = row;
+        }
+    }
+    if (state.bestQualities.empty() || quality > state.bestQualities.back()) {
+        state.bestQualities.push_back(quality);
+        state.lastImprovement = state.generation;
+    } else {
+        state.bestQualities.push_back(state.bestQualities.back());
     }
 
-    // For each genome, calculate its fitness from its score
-    using GenomeFitness = std::pair<Genome, double>;
-    std::vector<GenomeFitness> fitnessedGenomes;
-    for (auto it = scoredGenomes.begin(); it != scoredGenomes.end(); it++) {
-        fitnessedGenomes.emplace_back(std::make_pair(it->first, it->second.convertScoreToFitness(minValues, maxValues)));
+    // Check stopping conditions, target first as it can't be improved on
+    state.stopReason = StopReason::None;
+    if (settings.stopAtLowerBounds && generation.size() != 0) {
+        const Scores & best = generation.scores[generation.rowOf(0)];
+        bool reached = true;
+        for (size_t c = 0; c < CRITERIA_COUNT; c++) {
+            if (best.isEnabled(static_cast<Criterion>(c)) && best.values[c] > lowerBounds.values[c]) {
+                reached = false;
+            }
+        }
+        if (reached) {
+            state.stopReason = StopReason::TargetReached;
+            return;
+        }
     }
 
-    // Sort genomes based on fitness
-    std::sort(fitnessedGenomes.begin(), fitnessedGenomes.end(), [ ] (const GenomeFitness & lhs, const GenomeFitness & rhs) -> bool {
-        return lhs.second > rhs.second;
-        });
+    if (settings.stagnationLimit != 0 && state.generation - state.lastImprovement >= settings.stagnationLimit) {
+        state.stopReason = StopReason::Stagnation;
+        return;
+    }
 
+    if (settings.improvementWindow != 0 && state.generation >= settings.improvementWindow) {
+        double improvement = state.bestQualities.back() - state.bestQualities[state.generation - settings.improvementWindow];
+        if (improvement < settings.minimalImprovement) {
+            state.stopReason = StopReason::SlowImprovement;
+            return;
+        }
+    }
 
-    // Select only generation size of best genomes
-    std::vector<Genome> result;
-    if (generationSize > fitnessedGenomes.size()) {
-        generationSize = fitnessedGenomes.size();
+    if (settings.diversityThreshold > 0) {
+        state.diversity = diversity(generation);
+        if (state.diversity < settings.diversityThreshold) {
+            state.stopReason = StopReason::LowDiversity;
+        }
     }
-    for (size_t i = 0; i < generationSize; i++) {
-        result.emplace_back(fitnessedGenomes[i].first);
+}
+
+StopReason Evolution::interruption(const EvolutionState & state) const {
+    if (state.stopToken.stop_requested()) {
+        return StopReason::Cancelled;
     }
 
-    std::swap(newGeneration, result);
+    if (state.deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= state.deadline) {
+        return StopReason::DeadlineReached;
+    }
+
+    return StopReason::None;
 }
 
-Scores Evolution::score(const Genome & genome) const {
+void Evolution::localSearch(EvolutionState & state) {
+    Population & generation = state.currentGeneration;
+    size_t count = std::min(settings.localSearchElites, generation.size());
+    if (count == 0) {
+        return;
+    }
+
+    // Every elite has the same share of evaluations, so the result does not depend on thread count
+    auto [ minValues, maxValues ] = fitnessBounds(generation);
+    size_t budget = settings.localSearchEvaluations / count;
+    std::atomic<bool> improved(false);
+    threadPool->parallelFor(count, [ & ] (size_t rank, size_t worker) {
+        size_t row = generation.rowOf(rank);
+        IncrementalScorer & scorer = *localSearchScorers[worker];
+        generation.genes.load(row, localSearchGenomes[worker]);
+        scorer.reset(localSearchGenomes[worker]);
+
+        double fitness = generation.scores[row].convertScoreToFitness(minValues, maxValues);
+        size_t evaluations = 0;
+        bool changed = false;
+        while (evaluations < budget) { // Passes over all genes, until no change improves
+            double bestFitness = fitness;
+            size_t bestGene = genomeSize;
+            uint32_t bestValue = 0;
+            for (size_t gene = 0; gene < genomeSize && evaluations < budget; gene++) {
+                if (interruption(state) != StopReason::None) {
+                    evaluations = budget;
+                    break;
+                }
+
+                uint32_t valueCount = problem->valueCount(gene);
+                for (uint32_t value = 0; value < valueCount && evaluations < budget; value++) {
+                    if (value == scorer.getGenome()[gene]) {
+                        continue;
+                    }
+
+                    evaluations++;
+                    double candidate = scorer.getScoresWith(gene, value).convertScoreToFitness(minValues, maxValues);
+                    if (candidate > bestFitness) {
+                        bestFitness = candidate;
+                        bestGene = gene;
+                        bestValue = value;
+                        if (settings.localSearch == LocalSearchType::FirstImprovement) {
+                            scorer.change(gene, value);
+                            fitness = candidate;
+                            changed = true;
+                        }
+                    }
+                }
+            }
 
-    // Get all intervals
-    using IntervalEntry = std::pair<TimeInterval, std::shared_ptr<Entry>>;
-    std::vector<IntervalEntry> intervals;
+            if (bestGene == genomeSize) { // Local optimum
+                break;
+            }
+            if (settings.localSearch == LocalSearchType::SteepestDescent) {
+                scorer.change(bestGene, bestValue);
+                fitness = bestFitness;
+                changed = true;
+            }
+        }
 
-    for (size_t genomeIndex = 0; genomeIndex < genomeSize; genomeIndex++) {
-        std::shared_ptr<Entry> entry = genomeIndexToSchedule[genomeIndex]->entriesPtrs[genome[genomeIndex]];
-        for (auto & interval : entry->timeslots) {
-            intervals.push_back(std::make_pair(interval, entry));
+        if (changed) {
+            const Genome & genome = scorer.getGenome();
+            generation.genes.store(row, genome);
+            generation.hashes[row] = genomeHasher->hash(genome);
+            generation.scores[row] = scorer.getScores();
+            improved.store(true, std::memory_order_relaxed);
         }
+        });
+
+    if (improved.load()) {
+        rerank(generation);
     }
+}
 
-    // Calculate score using sorted intervals
-    Scores result(priorities);
-    result.calculateScore(intervals);
-    return result;
+void Evolution::rerank(Population & generation) const {
+
+    // Rank generation again, ties keep previous order
+    auto [ minValues, maxValues ] = fitnessBounds(generation);
+    for (size_t rank = 0; rank < generation.size(); rank++) {
+        size_t row = generation.rowOf(rank);
+        generation.fitness[row] = generation.scores[row].convertScoreToFitness(minValues, maxValues);
+        generation.orders[row] = rank;
+    }
+    generation.rank(generation.size());
 }
 
-bool Evolution::mutate(Genome & genome) const {
-    // Generate random number and calculate if mutation will be performed
-    size_t flag = randomNumber(EVOLUTION_MUTATION_ONE_IN);
-    if (flag != 0) {
-        return false;
+double Evolution::diversity(const Population & generation) const {
+    size_t count = generation.size();
+    if (count == 0 || genomeSize == 0) {
+        return 0;
     }
 
-    // Perform random mutation on random location
-    size_t randomIndex = randomNumber(genomeSize);
-    size_t maxValueOnIndex = genomeIndexToSchedule[randomIndex]->entriesPtrs.size();
-    genome[randomIndex] = randomNumber(maxValueOnIndex);
-    return true;
+    size_t maxValueCount = 0;
+    for (size_t gene = 0; gene < genomeSize; gene++) {
+        maxValueCount = std::max<size_t>(maxValueCount, problem->valueCount(gene));
+    }
+
+    // Count values of each gene, genomes without the most common value differ.
+    // Counts are not taken from arenas, statistics of a run can be asked for while another run steps
+    thread_local std::vector<uint32_t> counts;
+    counts.resize(std::max(counts.size(), maxValueCount));
+    size_t differing = 0;
+    for (size_t gene = 0; gene < genomeSize; gene++) {
+        std::fill(counts.begin(), counts.begin() + problem->valueCount(gene), 0);
+        uint32_t mostCommon = 0;
+        for (size_t row : generation.ranking) {
+            mostCommon = std::max(mostCommon, ++counts[generation.genes.get(row, gene)]);
+        }
+        differing += count - mostCommon;
+    }
+
+    return static_cast<double>(differing) / (static_cast<double>(count) * genomeSize);
+}
+
+void Evolution::selection(Population & generation) const {
+
+    // Calculate score of all genomes in parallel blocks
+    size_t count = generation.getCapacity();
+    size_t blockCount = (count + EVOLUTION_PARALLEL_BLOCK_SIZE - 1) / EVOLUTION_PARALLEL_BLOCK_SIZE;
+    threadPool->parallelFor(blockCount, [ & ] (size_t block, size_t worker) {
+        GenomeBuffer genome = arenas->forWorker(worker).allocateArray<uint32_t>(genomeSize);
+        size_t blockEnd = std::min((block + 1) * EVOLUTION_PARALLEL_BLOCK_SIZE, count);
+        for (size_t i = block * EVOLUTION_PARALLEL_BLOCK_SIZE; i < blockEnd; i++) {
+            generation.genes.load(i, genome);
+            generation.scores[i] = score(genome);
+            generation.hashes[i] = genomeHasher->hash(genome);
+        }
+        });
+
+    // Keep track of maximum and minimum of reached scores (or use static bounds)
+    Scores minValues = lowerBounds;
+    Scores maxValues = upperBounds;
+    if (settings.fitnessNormalisation == FitnessNormalisation::Population && count != 0) {
+        minValues = generation.scores.front();
+        maxValues = generation.scores.front();
+        for (size_t i = 0; i < count; i++) {
+            minValues.setToMinValuesFrom(generation.scores[i]);
+            maxValues.setToMaxValuesFrom(generation.scores[i]);
+        }
+    }
+
+    // Rank genomes based on fitness calculated from their score
+    for (size_t i = 0; i < count; i++) {
+        generation.fitness[i] = generation.scores[i].convertScoreToFitness(minValues, maxValues);
+        generation.orders[i] = i;
+    }
+    generation.rank(count);
 }
 
-std::vector<Genome> Evolution::createInitialGenerations(size_t generationSize) const {
+Scores Evolution::score(GenomeView genome) const {
 
-    std::vector<Genome> result;
+    // Intervals of genome are sorted in buffers reused by each thread
+    thread_local ScoreEvaluator::Workspace workspace;
+    return evaluator->evaluate(genome, workspace);
+}
 
-    for (size_t i = 0; i < generationSize; i++) {
+Scores Evolution::cachedScore(GenomeView genome, uint64_t hash) const {
+    std::optional<Scores> cached = fitnessCache->find(genome, hash);
+    if (cached.has_value()) {
+        return *cached;
+    }
+
+    Scores result = score(genome);
+    fitnessCache->store(genome, hash, result);
+    return result;
+}
+
+size_t Evolution::mutate(GenomeBuffer genome, uint64_t & hash, Random & random) const {
+    // Number of failed attempts before a successful one is geometric,
+    // so failed attempts are skipped at once instead of drawing for each of them
+    static const double logFailure = std::log1p(-1.0 / EVOLUTION_MUTATION_ONE_IN);
+    size_t attempts = 1 + (genomeSize / EVOLUTION_MUTATION_DIVIDER);
+
+    size_t mutations = 0;
+    size_t attempt = 0;
+    while (true) {
+        attempt += static_cast<size_t>(std::log1p(-random.uniform()) / logFailure);
+        if (attempt >= attempts) {
+            break;
+        }
+
+        // Perform random mutation on random location
+        size_t randomIndex = random.below(genomeSize);
+        size_t maxValueOnIndex = problem->valueCount(randomIndex);
+        uint32_t newValue = static_cast<uint32_t>(random.below(maxValueOnIndex));
+        hash = genomeHasher->update(hash, randomIndex, genome[randomIndex], newValue);
+        genome[randomIndex] = newValue;
+
+        mutations++;
+        attempt++;
+    }
+
+    return mutations;
+}
+
+void Evolution::createInitialGeneration(Population & generation, Random & random) const {
+
+    for (size_t i = 0; i < generation.getCapacity(); i++) {
 
         // Create random genome
-        Genome newGenome;
         for (size_t j = 0; j < genomeSize; j++) {
-            size_t maxValue = genomeIndexToSchedule[j]->entriesPtrs.size();
-            newGenome.push_back(randomNumber(maxValue));
+            size_t maxValue = problem->valueCount(j);
+            generation.genes.set(i, j, random.below(maxValue));
         }
-        result.push_back(newGenome);
     }
-
-    return result;
 }
 
-size_t Evolution::randomNumber(size_t maxValue) {
+EvolutionRun::EvolutionRun(Evolution & e, size_t generationSize, size_t maxGenerations,
+    std::stop_token stopToken, std::chrono::steady_clock::time_point deadline) :
+    evolution(e),
+    state(e.start(generationSize)),
+    maxGenerations(maxGenerations) {
 
-    static std::random_device device;
-    static std::mt19937 rng(device());
+    if (maxGenerations == 0) {
+        throw std::invalid_argument("Generation counts can't be zero.");
+    }
+
+    state.stopToken = stopToken;
+    state.deadline = deadline;
+}
 
-    // Upper limit is uninclusive, so decrease the value by one
-    if (maxValue != 0) {
-        maxValue--;
+bool EvolutionRun::next() {
+    if (isFinished()) {
+        return false;
+    }
+
+    size_t generation = state.generation;
+    evolution.step(state);
+    if (state.generation >= maxGenerations && state.stopReason == StopReason::None) {
+        state.stopReason = StopReason::GenerationLimit;
     }
 
-    std::uniform_int_distribution<size_t> distribution(0, maxValue);
+    return state.generation != generation;
+}
+
+bool EvolutionRun::isFinished() const {
+    return state.stopReason != StopReason::None;
+}
+
+GenerationStatistics EvolutionRun::statistics() const {
+    return evolution.statistics(state);
+}
+
+std::vector<EvolutionResult> EvolutionRun::result() const {
+    return evolution.result(state);
+}
 
-    return distribution(rng);
+EvolutionState & EvolutionRun::getState() {
+    return state;
 }
@@ -15,7 +15,18 @@
 #include "Data/subjects.h"
 #include "Data/priorities.h"
 #include "Evolution/crossovers.h"
+#include "Evolution/selections.h"
+#include "Evolution/population.h"
+#include "Evolution/survivors.h"
+#include "Evolution/fitnesscache.h"
+#include "Evolution/problem.h"
+#include "Evolution/evaluator.h"
+#include "Evolution/incremental.h"
 #include "Evolution/scores.h"
+#include "Evolution/settings.h"
+#include "Evolution/random.h"
+#include "Utility/threadpool.h"
+#include "Utility/arena.h"
 
 #include <vector>
 #include <tuple>
@@ -25,6 +36,8 @@
 #include <algorithm>
 #include <iostream>
 #include <functional>
+#include <chrono>
+#include <stop_token>
 
 /**
  * @brief Course and Schedule name
@@ -51,6 +64,77 @@ using EntryAddress = std::pair<std::string, std::string>;
  */
 using EvolutionResult = std::pair<EntryAddress, std::shared_ptr<Entry>>;
 
+/**
+ * @brief Genome sent between runs of evolution, with its scores
+ *
+ */
+struct Migrant {
+    Genome genome; //!< Genome
+    Scores scores; //!< Scores of genome
+};
+
+/**
+ * @brief Reason why a run of evolution stopped
+ *
+ * @see EvolutionSettings
+ *
+ */
+enum class StopReason {
+    None, //!< Run has not stopped
+    GenerationLimit, //!< Maximum number of generations was reached
+    Stagnation, //!< Best timetable did not improve for given number of generations
+    SlowImprovement, //!< Best timetable improved less than required over window
+    TargetReached, //!< Best timetable reached lowest possible value of every criterion
+    LowDiversity, //!< Diversity of generation dropped below threshold
+    DeadlineReached, //!< Deadline of the run passed
+    Cancelled //!< Stop of the run was requested
+};
+
+/**
+ * @brief State of a run of evolution between generations
+ *
+ * @see Evolution::start
+ * @see Evolution::step
+ *
+ */
+struct EvolutionState {
+    Population currentGeneration; //!< Current generation, ranked by fitness
+    Population nextGeneration; //!< Storage the next generation is created in
+    size_t generation; //!< Number of finished generations
+    size_t evaluations; //!< Offsprings created and scored in all finished generations
+    size_t offspringCount; //!< Offsprings created in each generation
+    size_t eliteSize; //!< Best genomes of current generation passed to the next one
+
+    Scores referenceMin; //!< Lowest scores of initial generation, quality of timetables is measured against them
+    Scores referenceMax; //!< Highest scores of initial generation
+    std::vector<double> bestQualities; //!< Quality of best timetable found so far, after each generation (from initial one)
+    size_t lastImprovement; //!< Generation in which quality of best timetable last improved
+    double diversity; //!< Diversity of current generation (measured only with threshold set, otherwise one)
+    size_t bestRow; //!< Row of current generation with the best quality
+    StopReason stopReason; //!< Why the run stopped, None while it can continue
+
+    std::chrono::steady_clock::time_point deadline; //!< No offsprings are created after it (max for no deadline)
+    std::stop_token stopToken; //!< No offsprings are created after stop is requested on it
+};
+
+/**
+ * @brief Statistics of a run of evolution after a generation
+ *
+ * Quality of timetables is their fitness against scores of initial generation (see EvolutionSettings).
+ *
+ * @see Evolution::statistics
+ *
+ */
+struct GenerationStatistics {
+    size_t generation; //!< Number of finished generations
+    size_t evaluations; //!< Offsprings created and scored in all finished generations
+    Scores bestScores; //!< Scores of best timetable of generation
+    double bestQuality; //!< Quality of best timetable found so far
+    double meanQuality; //!< Mean quality of timetables of generation
+    double diversity; //!< Diversity of generation, in range 0-1
+    StopReason stopReason; //!< Why the run stopped, None while it can continue
+};
+
 /**
  * @brief Evolution algorithm for timetable generation
  *
@@ -69,10 +153,33 @@ class Evolution {
 
 
     std::vector<std::unique_ptr<Crossover>> crossovers; // Crossover operators
+    std::unique_ptr<ParentSelection> parentSelection; // Parent selection operator
+
+    EvolutionSettings settings; // Settings of the algorithm
+
+    CriteriaMask criteria; // Criteria enabled by priorities
+
+    // Lowest and highest scores any timetable can reach, used for static fitness normalisation
+    Scores lowerBounds;
+    Scores upperBounds;
+
+    std::unique_ptr<ProblemModel> problem; // Flat model of schedules used during evolution
+    size_t geneWidth; // Bytes of one gene in population matrix, enough for the largest schedule
+    std::unique_ptr<GenomeHasher> genomeHasher; // Hashing of genomes for cache
+    std::unique_ptr<ScoreEvaluator> evaluator; // Fused calculation of scores
+    std::unique_ptr<FitnessCache> fitnessCache; // Scores of recently seen genomes
+    std::vector<std::unique_ptr<IncrementalScorer>> localSearchScorers; // Scorer for local search of each worker (if enabled)
+    std::vector<Genome> localSearchGenomes; // Genome being improved by each worker
+
+    std::unique_ptr<ThreadPool> threadPool; // Workers for parallel creation and scoring of offsprings
+    std::unique_ptr<WorkerArenas> arenas; // Memory of data living for one generation, one arena for each worker
 
     std::function<void(size_t, size_t)> processing; // Function to be called after every stage of evolution
     // first parameter is current progress value, second is max value
 
+    StopReason stopReason; // Why the last evolve stopped
+    size_t generationCount; // Generations of the last evolve
+
 public:
 
     Evolution() = delete;
@@ -84,24 +191,128 @@ public:
      * @param p priorities for timetable generation
      * @param proc function to be called after every stage of evolution,
      * where first parameter is current progress value, second is max value
+     * @param e settings of the algorithm
      */
     Evolution(
         const Semester & s,
         const Priorities & p,
-        std::function<void(size_t, size_t)> proc = nullptr);
+        std::function<void(size_t, size_t)> proc = nullptr,
+        const EvolutionSettings & e = EvolutionSettings());
 
     ~Evolution() = default;
 
     /**
      * @brief Generate timetable using genetic algorithm
      *
+     * Each generation creates generation size * offspring multiplier offsprings (see EvolutionSettings).
+     * Evolution stops early when a stopping condition of settings is met, or when stop is requested
+     * on token (then best timetable so far is returned).
+     *
      * @throws std::invalid_argument generation size or number of generations is zero
      *
      * @param generationSize size of generations
      * @param maxGenerations number of generations
+     * @param stopToken token for cancelling evolution from other thread
      * @return std::vector<EvolutionResult> generated timetable (vector of selected Entries for each Course and its Schedule)
      */
-    std::vector<EvolutionResult> evolve(size_t generationSize = 100, size_t maxGenerations = 100);
+    std::vector<EvolutionResult> evolve(size_t generationSize = 100, size_t maxGenerations = 100, std::stop_token stopToken = std::stop_token());
+
+    /**
+     * @brief Generate timetable using genetic algorithm until deadline
+     *
+     * Deadline is checked before every offspring, when it passes the current generation
+     * is finished with offsprings created so far. Initial generation is always created whole.
+     * Every time a better timetable is found, it is passed to the callback, so it can be used
+     * before evolution ends. Timetables are compared by quality (see EvolutionSettings).
+     *
+     * Unlike evolve, the result depends on speed of the machine.
+     *
+     * @throws std::invalid_argument generation size or number of generations is zero
+     *
+     * @param generationSize size of generations
+     * @param maxGenerations maximum number of generations
+     * @param deadline time after which evolution stops
+     * @param improved function to be called with every better timetable and its scores (may be empty)
+     * @param stopToken token for cancelling evolution from other thread, checked like deadline
+     * @return std::vector<EvolutionResult> best timetable found
+     */
+    std::vector<EvolutionResult> evolveUntil(size_t generationSize, size_t maxGenerations,
+        std::chrono::steady_clock::time_point deadline,
+        const std::function<void(const std::vector<EvolutionResult> &, const Scores &)> & improved = nullptr,
+        std::stop_token stopToken = std::stop_token());
+
+    /**
+     * @brief Start a run of evolution
+     *
+     * Creates and ranks initial generation. The run is advanced by step,
+     * runs of the same evolution must not be stepped concurrently.
+     *
+     * @throws std::invalid_argument generation size is zero
+     *
+     * @param generationSize size of generations
+     * @return EvolutionState state of the run
+     */
+    EvolutionState start(size_t generationSize);
+
+    /**
+     * @brief Create next generation of a run
+     *
+     * Sets reason to stop in state, when a stopping condition of settings is met,
+     * deadline of state passed or stop was requested on its token. The run can still be stepped further
+     * (unless it is interrupted). Generation finished after interruption has only offsprings created before it,
+     * no generation is created if the run is interrupted already.
+     *
+     * @param[inout] state state of the run
+     */
+    void step(EvolutionState & state);
+
+    /**
+     * @brief Get statistics of a run after its last generation
+     *
+     * @param state state of the run
+     * @return GenerationStatistics statistics
+     */
+    GenerationStatistics statistics(const EvolutionState & state) const;
+
+    /**
+     * @brief Convert best genome of a run to timetable
+     *
+     * @param state state of the run
+     * @return std::vector<EvolutionResult> timetable (vector of selected Entries for each Course and its Schedule)
+     */
+    std::vector<EvolutionResult> result(const EvolutionState & state) const;
+
+    /**
+     * @brief Convert genome to timetable
+     *
+     * @throws std::invalid_argument if genome has different size or a value out of range
+     *
+     * @param genome genome of this evolution
+     * @return std::vector<EvolutionResult> timetable (vector of selected Entries for each Course and its Schedule)
+     */
+    std::vector<EvolutionResult> timetable(GenomeView genome) const;
+
+    /**
+     * @brief Copy best genomes of a run
+     *
+     * @param state state of the run
+     * @param count maximum number of genomes
+     * @return std::vector<Migrant> best genomes, sorted from the best
+     */
+    std::vector<Migrant> emigrants(const EvolutionState & state, size_t count) const;
+
+    /**
+     * @brief Put genomes from elsewhere into current generation of a run
+     *
+     * Migrants replace the worst genomes (never the elite), then the generation is ranked again.
+     * Migrants have to come from evolution of the same semester and priorities.
+     *
+     * @throws std::invalid_argument if migrant has different genome size, criteria or a value out of range
+     *
+     * @param[inout] state state of the run
+     * @param migrants genomes with their scores
+     */
+    void immigrate(EvolutionState & state, const std::vector<Migrant> & migrants);
 
     /**
      * @brief Get size of genome
@@ -110,19 +321,140 @@ public:
      */
     size_t getGenomeSize() const;
 
+    /**
+     * @brief Get statistics of cache of scores
+     *
+     * Counters accumulate over all runs of this evolution.
+     *
+     * @return CacheStatistics statistics
+     */
+    CacheStatistics getCacheStatistics() const;
+
+    /**
+     * @brief Get statistics of arenas of workers
+     *
+     * Counters accumulate over all runs of this evolution.
+     *
+     * @return ArenaStatistics statistics
+     */
+    ArenaStatistics getArenaStatistics() const;
+
+    /**
+     * @brief Get reason why the last evolve stopped
+     *
+     * @return StopReason reason, None if evolve was not called yet
+     */
+    StopReason getStopReason() const;
+
+    /**
+     * @brief Get number of generations of the last evolve
+     *
+     * @return size_t number of generations
+     */
+    size_t getGenerationCount() const;
+
 private:
 
     /**
-     * @brief Performs selection of best genomes, based on fitness
+     * @brief Storage for creating offsprings, allocated from arena of a worker
+     *
+     */
+    struct OffspringBuffers {
+        GenomeBuffer lParent; // Widened genes of parent
+        GenomeBuffer rParent; // Widened genes of parent
+        GenomeBuffer child; // Genes of offspring
+    };
+
+    /**
+     * @brief Allocate storage for creating offsprings
+     *
+     * @param arena arena of the calling worker
+     * @return OffspringBuffers storage, valid until the arena is reset
+     */
+    OffspringBuffers allocateOffspringBuffers(Arena & arena) const;
+
+    /**
+     * @brief Create one offspring from current generation
+     *
+     * Parents are selected by parent selection, crossed over by random crossover
+     * and the child is mutated.
+     *
+     * @param current generation to select parents from (ranked by fitness)
+     * @param[out] buffers storage for parents and offspring, offspring is in its child
+     * @param random random number generator of the calling worker
+     * @param[out] hash hash of offspring
+     */
+    void createOffspring(const Population & current, const OffspringBuffers & buffers, Random & random, uint64_t & hash) const;
+
+    /**
+     * @brief Performs selection of initial generation, based on fitness
+     *
+     * All genomes of generation are scored and ranked by fitness, which is
+     * calculated relative to scores reached in this generation
+     * (or to static bounds, if set in settings).
+     *
+     * @param[inout] generation generation with genes in all rows
+     */
+    void selection(Population & generation) const;
+
+    /**
+     * @brief Lowest and highest scores for fitness of genomes judged against generation
+     *
+     * Scores reached by ranked genomes of generation, or static bounds (see EvolutionSettings).
+     *
+     * @param generation ranked generation
+     * @return std::pair<Scores, Scores> lowest and highest scores
+     */
+    std::pair<Scores, Scores> fitnessBounds(const Population & generation) const;
+
+    /**
+     * @brief Track progress of a run after a generation and check stopping conditions
+     *
+     * @param[inout] state state of the run, with ranked current generation
+     */
+    void updateConvergence(EvolutionState & state) const;
+
+    /**
+     * @brief Check if a run was interrupted from outside
+     *
+     * @param state state of the run
+     * @return StopReason Cancelled or DeadlineReached if interrupted, None otherwise
+     */
+    StopReason interruption(const EvolutionState & state) const;
+
+    /**
+     * @brief Improve best genomes of current generation by 1-opt local search
+     *
+     * Each gene is changed to every other entry of its schedule, changes are scored
+     * incrementally and improving ones are taken (see LocalSearchType), until no change improves
+     * the genome or its share of evaluations is used. Genomes are judged against current generation,
+     * the generation is ranked again if any genome improved.
+     *
+     * @param[inout] state state of the run
+     */
+    void localSearch(EvolutionState & state);
+
+    /**
+     * @brief Calculate fitness of all genomes of generation and rank it again
+     *
+     * Genomes with equal fitness keep their previous order.
+     *
+     * @param[inout] generation ranked generation
+     */
+    void rerank(Population & generation) const;
+
+    /**
+     * @brief Diversity of generation
      *
-     * Only amount of genomes up to generation size will be selected.
+     * Share of genomes differing from the most common value of a gene, averaged over all genes.
+     * Zero when all genomes are the same.
      *
-     * The returned genomes will be sorted by their fitness.
+     * Does not use arenas, so it is safe outside of step.
      *
-     * @param[inout] newGeneration generation
-     * @param generationSize desired size of generation
+     * @param generation generation
+     * @return double diversity in range 0-1
      */
-    void selection(std::vector<Genome> & newGeneration, size_t generationSize) const;
+    double diversity(const Population & generation) const;
 
     /**
      * @brief Score given genome
@@ -130,39 +462,117 @@ private:
      * @param genome genome to be scored
      * @return Scores score of genome
      */
-    Scores score(const Genome & genome) const;
+    Scores score(GenomeView genome) const;
+
+    /**
+     * @brief Score given genome, using cache of scores
+     *
+     * @param genome genome to be scored
+     * @param hash hash of genome
+     * @return Scores score of genome
+     */
+    Scores cachedScore(GenomeView genome, uint64_t hash) const;
 
     /**
      * @brief Mutate given genome
      *
-     * Genomes are mutated on random place with a certain mutation chance.
+     * Mutation is attempted once for each N genes (and once more), each attempt mutates
+     * random place with a certain mutation chance. Successful attempts are found
+     * by geometric skip-sampling.
      *
      * @param genome genome to be mutated
-     * @return true genome was mutated
-     * @return false genmoe was mutated
+     * @param[inout] hash hash of genome, updated on mutation
+     * @param random random number generator of the calling worker
+     * @return size_t number of mutations
      */
-    bool mutate(Genome & genome) const;
+    size_t mutate(GenomeBuffer genome, uint64_t & hash, Random & random) const;
 
     /**
      * @brief Create initial generation
      *
-     * Genomes are created randomly.
+     * Genomes are created randomly, one in each row of generation.
+     *
+     * @param[out] generation generation to fill
+     * @param random random number generator
+     */
+    void createInitialGeneration(Population & generation, Random & random) const;
+
+};
+
+/**
+ * @brief Run of evolution advanced one generation at a time
+ *
+ * Host can inspect statistics after every generation, interleave several runs on one thread
+ * and cancel a run on its stop token at any time (even while a generation is being created).
+ * Runs of the same evolution must not be advanced concurrently.
+ *
+ */
+class EvolutionRun {
+
+    Evolution & evolution; // Evolution the run belongs to
+    EvolutionState state; // State of the run
+    size_t maxGenerations; // Number of generations after which the run ends
+
+public:
+
+    EvolutionRun() = delete;
+
+    /**
+     * @brief Start a new run of evolution
+     *
+     * Creates initial generation.
+     *
+     * @throws std::invalid_argument generation size or number of generations is zero
+     *
+     * @param e evolution to run, has to outlive the run
+     * @param generationSize size of generations
+     * @param maxGenerations number of generations
+     * @param stopToken token for cancelling the run
+     * @param deadline time after which the run stops
+     */
+    EvolutionRun(
+        Evolution & e,
+        size_t generationSize,
+        size_t maxGenerations,
+        std::stop_token stopToken = std::stop_token(),
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    /**
+     * @brief Create next generation
+     *
+     * @return true generation was created, statistics describe it
+     * @return false run has ended (see statistics for reason), nothing was done
+     */
+    bool next();
+
+    /**
+     * @brief Check if the run has ended
      *
-     * @param generationSize Size of the generation
-     * @return std::vector<Genome> initial generation
+     * @return true run has ended
+     * @return false run can continue
      */
-    std::vector<Genome> createInitialGenerations(size_t generationSize) const;
+    bool isFinished() const;
 
     /**
-     * @brief Random number
+     * @brief Get statistics after the last generation
      *
-     * In range [0, maxValue).
+     * @return GenerationStatistics statistics
+     */
+    GenerationStatistics statistics() const;
+
+    /**
+     * @brief Convert best genome of current generation to timetable
      *
-     * @param maxValue upper limit
-     * @return size_t random number
+     * @return std::vector<EvolutionResult> timetable (vector of selected Entries for each Course and its Schedule)
      */
-    static size_t randomNumber(size_t maxValue);
+    std::vector<EvolutionResult> result() const;
 
+    /**
+     * @brief Get state of the run, e.g. for migration
+     *
+     * @return EvolutionState& state
+     */
+    EvolutionState & getState();
 };
 
 #endif /* EVOLUTION_H */
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "islands.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+MigrantMailbox::MigrantMailbox() : pending(nullptr) { }
+
+MigrantMailbox::~MigrantMailbox() {
+    delete pending.load();
+}
+
+void MigrantMailbox::send(std::vector<Migrant> migrants) {
+    // Whoever takes a batch out of the mailbox owns it,
+    // batch that was not received yet is replaced and dropped
+    std::unique_ptr<std::vector<Migrant>> batch(new std::vector<Migrant>(std::move(migrants)));
+    std::unique_ptr<std::vector<Migrant>> replaced(pending.exchange(batch.release(), std::memory_order_acq_rel));
+}
+
+std::vector<Migrant> MigrantMailbox::receive() {
+    std::unique_ptr<std::vector<Migrant>> batch(pending.exchange(nullptr, std::memory_order_acq_rel));
+    if (!batch) {
+        return std::vector<Migrant>();
+    }
+
+    return std::move(*batch);
+}
+
+IslandEvolution::IslandEvolution(const Semester & s, const Priorities & p, std::function<void(size_t, size_t)> proc,
+    const EvolutionSettings & e, const IslandSettings & i) :
+    islandSettings(i),
+    seed(e.seed),
+    islands(),
+    mailboxes(),
+    threadPool(),
+    processing(proc) {
+
+    size_t islandCount = islandSettings.islandCount;
+    if (islandCount == 0) {
+        islandCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Each island runs on one thread with its own seed
+    Random seeds(seed);
+    for (size_t island = 0; island < islandCount; island++) {
+        EvolutionSettings settings = e;
+        settings.threadCount = 1;
+        settings.seed = seeds.next();
+
+        islands.emplace_back(new Evolution(s, p, nullptr, settings));
+        mailboxes.emplace_back(new MigrantMailbox());
+    }
+
+    threadPool.reset(new ThreadPool(islandCount));
+}
+
+std::vector<EvolutionResult> IslandEvolution::evolve(size_t generationSize, size_t maxGenerations) {
+
+    if (generationSize == 0 || maxGenerations == 0) {
+        throw std::invalid_argument("Generation counts can't be zero.");
+    }
+
+    // Drop migrants left from previous run
+    for (auto & mailbox : mailboxes) {
+        mailbox->receive();
+    }
+
+    /**
+     * @brief Link of island to mailboxes of the other islands
+     *
+     */
+    struct MailboxLink : MigrationLink {
+        IslandEvolution & model;
+        size_t island;
+        Random random;
+
+        MailboxLink(IslandEvolution & m, size_t i) : model(m), island(i), random(m.seed, i + 1, 0) { }
+
+        void send(std::vector<Migrant> migrants) override {
+            size_t target = destination(model.islandSettings.topology, island, model.islands.size(), random);
+            model.mailboxes[target]->send(std::move(migrants));
+        }
+
+        std::vector<Migrant> receive() override {
+            return model.mailboxes[island]->receive();
+        }
+    };
+
+    // Single island has nobody to migrate to
+    IslandSettings settings = islandSettings;
+    if (islands.size() < 2) {
+        settings.migrationInterval = 0;
+    }
+
+    std::vector<Scores> bests(islands.size(), Scores(CriteriaMask(0)));
+    std::vector<std::vector<EvolutionResult>> results(islands.size());
+
+    threadPool->parallelFor(islands.size(), [ & ] (size_t island, size_t) {
+        Evolution & evolution = *islands[island];
+        MailboxLink link(*this, island);
+
+        EvolutionState state = evolution.start(generationSize);
+        runIsland(evolution, state, maxGenerations, settings, link, (island == 0) ? processing : nullptr);
+
+        bests[island] = evolution.emigrants(state, 1).front().scores;
+        results[island] = evolution.result(state);
+        });
+
+    return results[bestOf(bests)];
+}
+
+size_t IslandEvolution::getGenomeSize() const {
+    return islands.front()->getGenomeSize();
+}
+
+size_t IslandEvolution::getIslandCount() const {
+    return islands.size();
+}
+
+void IslandEvolution::runIsland(Evolution & evolution, EvolutionState & state, size_t maxGenerations,
+    const IslandSettings & settings, MigrationLink & link, const std::function<void(size_t, size_t)> & processing) {
+
+    while (state.generation < maxGenerations && state.stopReason == StopReason::None) {
+        if (processing != nullptr) {
+            processing(state.generation, maxGenerations);
+        }
+
+        evolution.step(state);
+
+        // Take migrants that arrived since last migration, then send own best genomes
+        if (settings.migrationInterval != 0 && state.generation % settings.migrationInterval == 0) {
+            evolution.immigrate(state, link.receive());
+            link.send(evolution.emigrants(state, settings.migrantCount));
+        }
+    }
+}
+
+size_t IslandEvolution::bestOf(const std::vector<Scores> & scores) {
+    Scores minValues = scores.front();
+    Scores maxValues = scores.front();
+    for (auto & score : scores) {
+        minValues.setToMinValuesFrom(score);
+        maxValues.setToMaxValuesFrom(score);
+    }
+
+    size_t best = 0;
+    double bestFitness = scores.front().convertScoreToFitness(minValues, maxValues);
+    for (size_t i = 1; i < scores.size(); i++) {
+        double fitness = scores[i].convertScoreToFitness(minValues, maxValues);
+        if (fitness > bestFitness) {
+            bestFitness = fitness;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+size_t IslandEvolution::destination(MigrationTopology topology, size_t island, size_t islandCount, Random & random) {
+    switch (topology) {
+        case MigrationTopology::Ring:
+            return (island + 1) % islandCount;
+        case MigrationTopology::Random:
+            break;
+    }
+
+    // Any island except the sending one
+    return (island + 1 + random.below(islandCount - 1)) % islandCount;
+}
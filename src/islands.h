@@ -0,0 +1,194 @@
+/**
+ * @file islands.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Island model of evolution across threads
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef ISLANDS_H
+#define ISLANDS_H
+
+#include "evolution.h"
+#include "Evolution/settings.h"
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Connection of an island to other islands
+ *
+ * Abstract class, implemented by transports of migrants (threads, processes).
+ * Neither sending nor receiving should wait for other islands.
+ *
+ */
+struct MigrationLink {
+
+    virtual ~MigrationLink() = default;
+
+    /**
+     * @brief Send best genomes of island to other island
+     *
+     * @param migrants migrants
+     */
+    virtual void send(std::vector<Migrant> migrants) = 0;
+
+    /**
+     * @brief Take migrants that arrived since last receive
+     *
+     * @return std::vector<Migrant> migrants, may be empty
+     */
+    virtual std::vector<Migrant> receive() = 0;
+};
+
+/**
+ * @brief Lock-free mailbox for migrants of one island
+ *
+ * Holds only the latest undelivered batch, a newer batch replaces an older one
+ * that was not received yet. Neither sending nor receiving ever blocks.
+ *
+ */
+class MigrantMailbox {
+
+    std::atomic<std::vector<Migrant> *> pending; // Latest undelivered batch, owned by mailbox
+
+public:
+
+    MigrantMailbox();
+
+    MigrantMailbox(const MigrantMailbox &) = delete;
+
+    MigrantMailbox & operator=(const MigrantMailbox &) = delete;
+
+    ~MigrantMailbox();
+
+    /**
+     * @brief Send batch of migrants, replacing undelivered batch
+     *
+     * Any number of islands can send at once.
+     *
+     * @param migrants migrants
+     */
+    void send(std::vector<Migrant> migrants);
+
+    /**
+     * @brief Take delivered batch of migrants
+     *
+     * @return std::vector<Migrant> migrants, empty if nothing was sent since last receive
+     */
+    std::vector<Migrant> receive();
+};
+
+/**
+ * @brief Evolution on independent islands with migration
+ *
+ * Each island runs its own Evolution (with its own operators, cache and random streams)
+ * on its own thread. Every few generations the best genomes of each island are sent to mailbox
+ * of another island, along a ring or to a random island, and received genomes replace
+ * the worst genomes of the receiving island.
+ *
+ * Islands never wait for each other, so migrants received depend on timing of threads
+ * and the result is not reproducible from seed, unless migration is disabled.
+ *
+ */
+class IslandEvolution {
+
+    IslandSettings islandSettings; // Settings of island model
+    uint64_t seed; // Master seed, seeds of islands are derived from it
+
+    std::vector<std::unique_ptr<Evolution>> islands; // Evolution of each island
+    std::vector<std::unique_ptr<MigrantMailbox>> mailboxes; // Mailbox of each island
+
+    std::unique_ptr<ThreadPool> threadPool; // One thread for each island
+
+    std::function<void(size_t, size_t)> processing; // Function to be called after every stage of evolution (by the first island)
+
+public:
+
+    IslandEvolution() = delete;
+
+    /**
+     * @brief Construct a new Island Evolution object
+     *
+     * @param s semester for which a timetable will be generated
+     * @param p priorities for timetable generation
+     * @param proc function to be called after every generation of the first island,
+     * where first parameter is current progress value, second is max value
+     * @param e settings of evolution on each island (thread count is ignored, each island runs on one thread)
+     * @param i settings of island model
+     */
+    IslandEvolution(
+        const Semester & s,
+        const Priorities & p,
+        std::function<void(size_t, size_t)> proc = nullptr,
+        const EvolutionSettings & e = EvolutionSettings(),
+        const IslandSettings & i = IslandSettings());
+
+    /**
+     * @brief Generate timetable using genetic algorithm on all islands
+     *
+     * @throws std::invalid_argument generation size or number of generations is zero
+     *
+     * @param generationSize size of generation of each island
+     * @param maxGenerations number of generations of each island
+     * @return std::vector<EvolutionResult> best timetable of all islands
+     */
+    std::vector<EvolutionResult> evolve(size_t generationSize = 100, size_t maxGenerations = 100);
+
+    /**
+     * @brief Get size of genome
+     *
+     * @return size_t size of genome
+     */
+    size_t getGenomeSize() const;
+
+    /**
+     * @brief Get number of islands
+     *
+     * @return size_t number of islands
+     */
+    size_t getIslandCount() const;
+
+    /**
+     * @brief Run evolution of one island until the last generation or until a stopping condition is met
+     *
+     * After every migration interval the island receives migrants from link, then sends its best genomes.
+     *
+     * @param evolution evolution of island
+     * @param[inout] state started run of island
+     * @param maxGenerations number of generations
+     * @param settings settings of island model
+     * @param link connection to other islands
+     * @param processing function to be called before every generation (may be empty)
+     */
+    static void runIsland(Evolution & evolution, EvolutionState & state, size_t maxGenerations,
+        const IslandSettings & settings, MigrationLink & link, const std::function<void(size_t, size_t)> & processing);
+
+    /**
+     * @brief Find best of timetables of islands
+     *
+     * Timetables are judged against each other, ties are won by lower index.
+     *
+     * @param scores scores of best timetable of each island (at least one)
+     * @return size_t index of best
+     */
+    static size_t bestOf(const std::vector<Scores> & scores);
+
+    /**
+     * @brief Island receiving migrants of given island
+     *
+     * @param topology topology of islands
+     * @param island index of sending island
+     * @param islandCount number of islands (at least two)
+     * @param random random number generator of sender
+     * @return size_t index of receiving island
+     */
+    static size_t destination(MigrationTopology topology, size_t island, size_t islandCount, Random & random);
+};
+
+#endif /* ISLANDS_H */
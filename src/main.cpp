@@ -13,16 +13,159 @@
 #include "Custom/StdinAdjuster.h"
 #include "Custom/StdoutOutputter.h"
 #include "evolution.h"
+#include "islands.h"
+#include "distributed.h"
+#include "branchandbound.h"
+#include "solver.h"
 
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <optional>
 
 #define SEPARATOR_LENGTH 80 //!< Length of visual separator on output
 #define GENERATION_SIZE_MULTIPLIER 4 //!< Multiplier of generation size (multiplies genome size)
 #define GENERATION_COUNT 100 //!< Default count of generations
 #define EVOLUTION_PROGRESS_BAR_WIDTH 50 //!< Width of evolution progress bar
 
+/**
+ * @brief Engine generating the timetable
+ *
+ */
+enum class Engine {
+    Automatic, //!< Engine chosen by size of semester (see Solver)
+    Single, //!< One evolution on threads of this process
+    Threads, //!< Islands on threads of this process
+    Processes, //!< Islands in worker processes
+    Exact //!< Exact search instead of evolution
+};
+
+/**
+ * @brief Options given on command line
+ *
+ */
+struct Options {
+    Engine engine = Engine::Automatic; //!< Engine generating the timetable
+    IslandSettings islandSettings; //!< Settings of island model (if islands are used)
+    size_t stagnationLimit = 0; //!< Generations without improvement before evolution stops (zero disables)
+    size_t timeLimit = 0; //!< Milliseconds the evolution or exact search can run (zero disables, only without islands)
+    size_t nodeLimit = ExactSearchSettings().nodeLimit; //!< Nodes the exact search can visit (zero disables)
+    size_t localSearchElites = 0; //!< Best genomes improved by local search every generation (zero disables)
+    size_t cacheSize = EvolutionSettings().cacheSize; //!< Genomes with cached scores (zero disables cache)
+    std::optional<uint64_t> seed; //!< Master seed of evolution (random if not given)
+};
+
+/**
+ * @brief Print usage of program to error stream
+ *
+ * @param program name of program
+ */
+void printUsage(const char * program) {
+    std::cerr << "Usage: " << program << " [options]\n";
+    std::cerr << "  --evolution              always use evolution (engine is chosen by size of semester by default)\n";
+    std::cerr << "  --islands N              run N islands on threads\n";
+    std::cerr << "  --processes N            run N islands in worker processes\n";
+    std::cerr << "  --migration-interval K   generations between migrations (0 disables migration)\n";
+    std::cerr << "  --migrants M             genomes sent by island in one migration\n";
+    std::cerr << "  --topology ring|random   islands receiving migrants\n";
+    std::cerr << "  --stagnation N           stop after N generations without improvement\n";
+    std::cerr << "  --time-limit MS          stop after MS milliseconds (without islands)\n";
+    std::cerr << "  --exact                  search the best timetable without collisions exactly\n";
+    std::cerr << "  --node-limit N           stop exact search after N nodes (0 disables)\n";
+    std::cerr << "  --local-search K         improve K best timetables by local search every generation\n";
+    std::cerr << "  --cache-size N           cache scores of N genomes (0 disables cache)\n";
+    std::cerr << "  --seed S                 seed of evolution, same seed gives same timetable (random by default)\n";
+}
+
+/**
+ * @brief Parse command line options
+ *
+ * In case of a wrong option, usage is outputted to error stream
+ * and the program is exited with failure.
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @return Options parsed options
+ */
+Options parseOptions(int argc, char ** argv) {
+    Options result;
+
+    auto fail = [ & ] () {
+        printUsage(argv[0]);
+        exit(EXIT_FAILURE);
+        };
+
+    // Value of option as a number
+    auto number = [ & ] (int & i) {
+        if (i + 1 >= argc) {
+            fail();
+        }
+        i++;
+
+        size_t position = 0;
+        size_t value = 0;
+        try {
+            value = std::stoul(argv[i], &position);
+        }
+        catch (...) {
+            fail();
+        }
+        if (position != std::strlen(argv[i]) || argv[i][0] == '-') {
+            fail();
+        }
+        return value;
+        };
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--evolution") {
+            result.engine = Engine::Single;
+        } else if (option == "--islands") {
+            result.engine = Engine::Threads;
+            result.islandSettings.islandCount = number(i);
+        } else if (option == "--processes") {
+            result.engine = Engine::Processes;
+            result.islandSettings.islandCount = number(i);
+        } else if (option == "--migration-interval") {
+            result.islandSettings.migrationInterval = number(i);
+        } else if (option == "--migrants") {
+            result.islandSettings.migrantCount = number(i);
+        } else if (option == "--stagnation") {
+            result.stagnationLimit = number(i);
+        } else if (option == "--time-limit") {
+            result.timeLimit = number(i);
+        } else if (option == "--exact") {
+            result.engine = Engine::Exact;
+        } else if (option == "--node-limit") {
+            result.nodeLimit = number(i);
+        } else if (option == "--local-search") {
+            result.localSearchElites = number(i);
+        } else if (option == "--cache-size") {
+            result.cacheSize = number(i);
+        } else if (option == "--seed") {
+            result.seed = number(i);
+        } else if (option == "--topology" && i + 1 < argc) {
+            std::string topology = argv[++i];
+            if (topology == "ring") {
+                result.islandSettings.topology = MigrationTopology::Ring;
+            } else if (topology == "random") {
+                result.islandSettings.topology = MigrationTopology::Random;
+            } else {
+                fail();
+            }
+        } else {
+            fail();
+        }
+    }
+
+    if (result.timeLimit != 0 && (result.engine == Engine::Threads || result.engine == Engine::Processes)) {
+        fail();
+    }
+
+    return result;
+}
+
 /**
  * @brief Checks the stdin for failure
  *
@@ -151,21 +294,65 @@ void evolutionLoadingBar(size_t value, size_t maxValue) {
 }
 
 /**
- * @brief Generates a timetable and outputs result to standard output
+ * @brief Describe why evolution stopped
  *
- * Function prompts the user to enter the number of generations to use.
+ * @param reason reason of stopping
+ * @return const char* description for user
+ */
+const char * describeStopReason(StopReason reason) {
+    switch (reason) {
+        case StopReason::None:
+        case StopReason::GenerationLimit:
+            break;
+        case StopReason::Stagnation:
+            return "best timetable stopped improving";
+        case StopReason::SlowImprovement:
+            return "best timetable improved too slowly";
+        case StopReason::TargetReached:
+            return "best possible timetable reached";
+        case StopReason::LowDiversity:
+            return "generation lost diversity";
+        case StopReason::DeadlineReached:
+            return "time limit reached";
+        case StopReason::Cancelled:
+            return "evolution was cancelled";
+    }
+    return "all generations done";
+}
+
+/**
+ * @brief Print use of cache of scores, for sizing the cache
  *
- * @param logo
- * @param semester Semester to generate timetable for
- * @param priorities Priorities to use
+ * @param statistics statistics of cache after evolution
  */
-void evolve(std::string & logo, Semester & semester, Priorities & priorities) {
-    std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
+void printCacheStatistics(const CacheStatistics & statistics) {
+    size_t lookups = statistics.hits + statistics.misses;
+    std::cout << "Score cache: " << statistics.hits << " hits, " << statistics.misses << " misses";
+    if (lookups != 0) {
+        std::cout << " (" << statistics.hits * 100 / lookups << "% hits)";
+    }
+    std::cout << ", capacity " << statistics.capacity << " genomes" << std::endl;
+}
 
-    // Create evolution and calculate generation size
-    Evolution evolution(semester, priorities, evolutionLoadingBar);
-    size_t generationSize = evolution.getGenomeSize() * GENERATION_SIZE_MULTIPLIER;
+/**
+ * @brief Print use of worker arenas, for sizing their blocks
+ *
+ * @param statistics statistics of arenas after evolution
+ */
+void printArenaStatistics(const ArenaStatistics & statistics) {
+    std::cout << "Worker arenas: " << statistics.allocations << " allocations from " << statistics.blocks
+              << " blocks, " << statistics.bytes << " bytes held" << std::endl;
+}
 
+/**
+ * @brief Load number of generations from user
+ *
+ * The user is prompted to enter the number of generations to use.
+ *
+ * @param logo string containing ascii art logo
+ * @return unsigned int number of generations
+ */
+unsigned int loadGenerationCount(std::string & logo) {
     std::cin.ignore(); // Clear previous character stuck in cin
 
     // Retrieve generation count
@@ -209,20 +396,219 @@ void evolve(std::string & logo, Semester & semester, Priorities & priorities) {
         break;
     } while (true);
 
+    return generationCount;
+}
+
+/**
+ * @brief Generates a timetable and outputs result to standard output
+ *
+ * Function prompts the user to enter the number of generations to use.
+ *
+ * Islands share the generation size, so each island has a part of it.
+ *
+ * @param logo
+ * @param semester Semester to generate timetable for
+ * @param priorities Priorities to use
+ * @param options options given on command line
+ */
+void evolve(std::string & logo, Semester & semester, Priorities & priorities, const Options & options) {
+    std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
+
+    // Create evolution and calculate generation size
+    EvolutionSettings settings;
+    settings.stagnationLimit = options.stagnationLimit;
+    settings.localSearchElites = options.localSearchElites;
+    settings.cacheSize = options.cacheSize;
+    if (options.seed.has_value()) {
+        settings.seed = *options.seed;
+    }
+    std::unique_ptr<Evolution> evolution;
+    std::unique_ptr<IslandEvolution> islands;
+    std::unique_ptr<ProcessIslandEvolution> processes;
+    size_t generationSize = 0;
+    switch (options.engine) {
+        case Engine::Single:
+            evolution.reset(new Evolution(semester, priorities, evolutionLoadingBar, settings));
+            generationSize = evolution->getGenomeSize() * GENERATION_SIZE_MULTIPLIER;
+            break;
+        case Engine::Threads:
+            islands.reset(new IslandEvolution(semester, priorities, evolutionLoadingBar, settings, options.islandSettings));
+            generationSize = islands->getGenomeSize() * GENERATION_SIZE_MULTIPLIER / islands->getIslandCount() + 1;
+            break;
+        case Engine::Processes:
+            processes.reset(new ProcessIslandEvolution(semester, priorities, evolutionLoadingBar, settings, options.islandSettings));
+            generationSize = processes->getGenomeSize() * GENERATION_SIZE_MULTIPLIER / processes->getProcessCount() + 1;
+            break;
+        case Engine::Automatic: // Not an evolution, see solve()
+        case Engine::Exact: // Not an evolution, see search()
+            break;
+    }
+
+    unsigned int generationCount = loadGenerationCount(logo);
+
     // Evolve
     std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
     std::cout << logo << std::endl;
-    std::cout << generationCount << " generations" << std::endl;
-    std::vector<EvolutionResult> result = evolution.evolve(generationSize, generationCount);
+    std::cout << generationCount << " generations (seed " << settings.seed << ")" << std::endl;
+    std::vector<EvolutionResult> result;
+    try {
+        if (evolution && options.timeLimit != 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeLimit);
+            result = evolution->evolveUntil(generationSize, generationCount, deadline);
+        } else if (evolution) {
+            result = evolution->evolve(generationSize, generationCount);
+        } else if (islands) {
+            result = islands->evolve(generationSize, generationCount);
+        } else {
+            result = processes->evolve(generationSize, generationCount);
+        }
+    }
+    catch (const std::exception & e) {
+        std::cerr << " (!) Problem generating timetable: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Print output
+    std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
+    std::cout << logo << std::endl;
+    if (evolution) {
+        std::cout << "Stopped after " << evolution->getGenerationCount() << " generations: "
+                  << describeStopReason(evolution->getStopReason()) << std::endl;
+        printCacheStatistics(evolution->getCacheStatistics());
+        printArenaStatistics(evolution->getArenaStatistics());
+    }
+    CS_StdoutOutputter outputter;
+    outputter.output(result);
+}
+
+/**
+ * @brief Describe outcome of exact search
+ *
+ * @param status outcome of search
+ * @return const char* description for user
+ */
+const char * describeSearchStatus(SearchStatus status) {
+    switch (status) {
+        case SearchStatus::Optimal:
+            return "best timetable without collisions found";
+        case SearchStatus::Infeasible:
+            return "every timetable has a collision";
+        case SearchStatus::LimitReached:
+            break;
+    }
+    return "limit reached, best timetable found so far";
+}
+
+/**
+ * @brief Searches the best timetable exactly and outputs result to standard output
+ *
+ * @param logo
+ * @param semester Semester to generate timetable for
+ * @param priorities Priorities to use
+ * @param options options given on command line
+ */
+void search(std::string & logo, Semester & semester, Priorities & priorities, const Options & options) {
+    std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
+    std::cout << logo << std::endl;
+    std::cout << "Exact search" << std::endl;
+
+    ExactSearchSettings settings;
+    settings.nodeLimit = options.nodeLimit;
+    settings.timeLimit = options.timeLimit;
+
+    std::vector<EvolutionResult> result;
+    std::unique_ptr<BranchAndBound> branchAndBound;
+    try {
+        branchAndBound.reset(new BranchAndBound(semester, priorities, settings));
+        result = branchAndBound->solve();
+    }
+    catch (const std::exception & e) {
+        std::cerr << " (!) Problem searching timetable: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
 
     // Print output
     std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
     std::cout << logo << std::endl;
+    std::cout << "Stopped after " << branchAndBound->getNodeCount() << " nodes: "
+              << describeSearchStatus(branchAndBound->getStatus()) << std::endl;
+    if (result.empty()) {
+        return;
+    }
+    CS_StdoutOutputter outputter;
+    outputter.output(result);
+}
+
+/**
+ * @brief Generates a timetable by engine chosen for the semester and outputs result to standard output
+ *
+ * Function prompts the user to enter the number of generations only if evolution is chosen.
+ *
+ * @param logo
+ * @param semester Semester to generate timetable for
+ * @param priorities Priorities to use
+ * @param options options given on command line
+ */
+void solve(std::string & logo, Semester & semester, Priorities & priorities, const Options & options) {
+    std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
+
+    // Create solver, choosing engine
+    EvolutionSettings settings;
+    settings.stagnationLimit = options.stagnationLimit;
+    settings.localSearchElites = options.localSearchElites;
+    settings.cacheSize = options.cacheSize;
+    if (options.seed.has_value()) {
+        settings.seed = *options.seed;
+    }
+    ExactSearchSettings exactSettings;
+    exactSettings.nodeLimit = options.nodeLimit;
+    std::unique_ptr<Solver> solver;
+    try {
+        solver.reset(new Solver(semester, priorities, evolutionLoadingBar, settings, exactSettings));
+    }
+    catch (const std::exception & e) {
+        std::cerr << " (!) Problem generating timetable: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int generationCount = GENERATION_COUNT;
+    if (solver->getChoice().engine == SolverEngine::Evolution) {
+        generationCount = loadGenerationCount(logo);
+    }
+
+    // Solve
+    std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
+    std::cout << logo << std::endl;
+    std::cout << "Engine: " << Solver::describe(solver->getChoice().engine) << " (" << solver->getChoice().reason << ")" << std::endl;
+    if (solver->getChoice().engine == SolverEngine::Evolution) {
+        std::cout << generationCount << " generations (seed " << settings.seed << ")" << std::endl;
+    }
+    std::vector<EvolutionResult> result;
+    try {
+        result = solver->solve(solver->getGenomeSize() * GENERATION_SIZE_MULTIPLIER, generationCount, options.timeLimit);
+    }
+    catch (const std::exception & e) {
+        std::cerr << " (!) Problem generating timetable: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Print output, engine may have changed if exact search found nothing
+    std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
+    std::cout << logo << std::endl;
+    std::cout << "Engine: " << Solver::describe(solver->getChoice().engine) << " (" << solver->getChoice().reason << ")" << std::endl;
+    if (solver->getEvolution() != nullptr) {
+        std::cout << "Stopped after " << solver->getEvolution()->getGenerationCount() << " generations: "
+                  << describeStopReason(solver->getEvolution()->getStopReason()) << std::endl;
+        printCacheStatistics(solver->getEvolution()->getCacheStatistics());
+        printArenaStatistics(solver->getEvolution()->getArenaStatistics());
+    }
     CS_StdoutOutputter outputter;
     outputter.output(result);
 }
 
-int main() {
+int main(int argc, char ** argv) {
+    Options options = parseOptions(argc, argv);
+
     std::cout << "\033[1;1H\033[2J" << std::endl; // Clean console
 
     std::string logo; // Ascii art logo
@@ -235,7 +621,13 @@ int main() {
 
     Semester semester = loadSemester(logo);
     Priorities priorities = loadPriorities(logo, semester);
-    evolve(logo, semester, priorities);
+    if (options.engine == Engine::Automatic) {
+        solve(logo, semester, priorities, options);
+    } else if (options.engine == Engine::Exact) {
+        search(logo, semester, priorities, options);
+    } else {
+        evolve(logo, semester, priorities, options);
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "solver.h"
+
+#include "Evolution/problem.h"
+#include "Evolution/occupancy.h"
+#include "Evolution/evaluator.h"
+#include "Evolution/scores.h"
+
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+// Largest number of timetables scored one by one
+#define ENUMERATION_LIMIT 100000
+// Largest expected number of timetables without collisions searched exactly
+#define EXACT_FEASIBLE_LIMIT 1000000
+// Number of timetables enumerated between checks of deadline
+#define ENUMERATION_DEADLINE_INTERVAL 1024
+
+Solver::Solver(const Semester & s, const Priorities & p, std::function<void(size_t, size_t)> proc,
+    const EvolutionSettings & e, const ExactSearchSettings & x) :
+    semester(s),
+    priorities(p),
+    processing(proc),
+    settings(e),
+    exactSettings(x),
+    estimate(choose(s, p)),
+    choice(estimate),
+    evolution() { }
+
+std::vector<EvolutionResult> Solver::solve(size_t generationSize, size_t maxGenerations, size_t timeLimit) {
+
+    if (generationSize == 0 || maxGenerations == 0) {
+        throw std::invalid_argument("Generation counts can't be zero.");
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimit);
+    choice = estimate;
+    evolution.reset();
+
+    if (choice.engine == SolverEngine::Enumeration) {
+        return enumerate(timeLimit != 0 ? deadline : std::chrono::steady_clock::time_point::max());
+    }
+
+    if (choice.engine == SolverEngine::Exact) {
+        ExactSearchSettings searchSettings = exactSettings;
+        if (timeLimit != 0) {
+            searchSettings.timeLimit = timeLimit;
+        }
+
+        BranchAndBound branchAndBound(semester, priorities, searchSettings);
+        std::vector<EvolutionResult> result = branchAndBound.solve();
+        if (!result.empty()) {
+            if (branchAndBound.getStatus() == SearchStatus::LimitReached) {
+                choice.reason += ", but exact search reached its limit (best timetable found so far)";
+            }
+            return result;
+        }
+
+        // Evolution still finds timetable with fewest collisions
+        choice.engine = SolverEngine::Evolution;
+        choice.reason += branchAndBound.getStatus() == SearchStatus::Infeasible
+            ? ", but every timetable has a collision"
+            : ", but exact search reached its limit without a timetable";
+    }
+
+    evolution.reset(new Evolution(semester, priorities, processing, settings));
+    if (timeLimit != 0) {
+        return evolution->evolveUntil(generationSize, maxGenerations, deadline);
+    }
+    return evolution->evolve(generationSize, maxGenerations);
+}
+
+const SolverChoice & Solver::getChoice() const {
+    return choice;
+}
+
+const Evolution * Solver::getEvolution() const {
+    return evolution.get();
+}
+
+size_t Solver::getGenomeSize() const {
+    return semester.schedulePtrs.size();
+}
+
+SolverChoice Solver::choose(const Semester & s, const Priorities & p) {
+    ProblemModel problem(s.schedulePtrs);
+    OccupancyModel occupancy(problem);
+
+    // Same genes as enumeration goes through, so it is not chosen for more timetables than the limit
+    std::vector<size_t> genes = enumeratedGenes(problem, p);
+
+    // Count colliding pairs of entries of each two schedules (ignored ones never collide)
+    double searchSpace = 1;
+    double expectedFeasible = 1;
+    double pairs = 0;
+    double collidingPairs = 0;
+    for (size_t l = 0; l < genes.size(); l++) {
+        size_t lGene = genes[l];
+        searchSpace *= problem.valueCount(lGene);
+        expectedFeasible *= problem.valueCount(lGene);
+        if (problem.isIgnored(lGene)) {
+            continue;
+        }
+
+        for (size_t r = l + 1; r < genes.size(); r++) {
+            size_t rGene = genes[r];
+            if (problem.isIgnored(rGene)) {
+                continue;
+            }
+
+            double colliding = 0;
+            for (uint32_t lValue = 0; lValue < problem.valueCount(lGene); lValue++) {
+                for (uint32_t rValue = 0; rValue < problem.valueCount(rGene); rValue++) {
+                    if (OccupancyModel::intersects(occupancy.bitmap(lGene, lValue), occupancy.bitmap(rGene, rValue), occupancy.getWordCount())
+                        && problem.collisions(problem.entryIndex(lGene, lValue), problem.entryIndex(rGene, rValue)) != 0) {
+                        colliding++;
+                    }
+                }
+            }
+
+            double all = double(problem.valueCount(lGene)) * problem.valueCount(rGene);
+            if (all != 0) {
+                expectedFeasible *= 1 - colliding / all;
+            }
+            pairs += all;
+            collidingPairs += colliding;
+        }
+    }
+
+    SolverChoice result;
+    result.searchSpace = searchSpace;
+    result.tightness = pairs == 0 ? 0 : collidingPairs / pairs;
+    result.expectedFeasible = expectedFeasible;
+
+    std::ostringstream reason;
+    reason.precision(3);
+    if (searchSpace <= ENUMERATION_LIMIT) {
+        result.engine = SolverEngine::Enumeration;
+        reason << searchSpace << " timetables can be scored one by one";
+    } else if (expectedFeasible <= EXACT_FEASIBLE_LIMIT) {
+        result.engine = SolverEngine::Exact;
+        reason << "about " << expectedFeasible << " of " << searchSpace << " timetables are without collisions, "
+               << result.tightness * 100 << "% of pairs of entries collide";
+    } else {
+        result.engine = SolverEngine::Evolution;
+        reason << "about " << expectedFeasible << " of " << searchSpace << " timetables are without collisions, too many to search";
+    }
+    result.reason = reason.str();
+
+    return result;
+}
+
+const char * Solver::describe(SolverEngine engine) {
+    switch (engine) {
+        case SolverEngine::Enumeration:
+            return "enumeration";
+        case SolverEngine::Exact:
+            return "exact search";
+        case SolverEngine::Evolution:
+            break;
+    }
+    return "evolution";
+}
+
+std::vector<EvolutionResult> Solver::enumerate(std::chrono::steady_clock::time_point deadline) {
+    ProblemModel problem(semester.schedulePtrs);
+    ScoreEvaluator evaluator(problem, priorities);
+    ScoreEvaluator::Workspace workspace;
+
+    // Timetables are compared like by static fitness normalisation of evolution
+    Scores lowerBounds(priorities);
+    Scores upperBounds(priorities);
+    lowerBounds.setToLowerBounds(semester.schedulePtrs, priorities);
+    upperBounds.setToUpperBounds(semester.schedulePtrs, priorities);
+
+    for (size_t gene = 0; gene < problem.getGeneCount(); gene++) {
+        if (problem.valueCount(gene) == 0) {
+            throw std::invalid_argument("Schedule has no entries.");
+        }
+    }
+    std::vector<size_t> genes = enumeratedGenes(problem, priorities);
+
+    // Go through all timetables like an odometer
+    Genome genome(problem.getGeneCount(), 0);
+    Genome best;
+    double bestFitness = 0;
+    size_t enumerated = 0;
+    do {
+        if (++enumerated % ENUMERATION_DEADLINE_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline) {
+            choice.reason += ", but time limit was reached (best timetable found so far)";
+            break;
+        }
+
+
+        double fitness = evaluator.evaluate(genome, workspace).convertScoreToFitness(lowerBounds, upperBounds);
+        if (best.empty() || fitness > bestFitness) {
+            best = genome;
+            bestFitness = fitness;
+        }
+
+        size_t i = 0;
+        while (i < genes.size() && ++genome[genes[i]] == problem.valueCount(genes[i])) {
+            genome[genes[i]] = 0;
+            i++;
+        }
+        if (i == genes.size()) {
+            break;
+        }
+    } while (true);
+
+    // Convert best genome to result
+    std::vector<EvolutionResult> result;
+    for (size_t i = 0; i < best.size(); i++) {
+        std::shared_ptr<Schedule> schedule = semester.schedulePtrs[i];
+        EntryAddress address = std::make_pair(schedule->course, schedule->name);
+
+        result.emplace_back(std::make_pair(address, schedule->entriesPtrs[best[i]]));
+    }
+
+    return result;
+}
+
+std::vector<size_t> Solver::enumeratedGenes(const ProblemModel & problem, const Priorities & p) {
+
+    // Ignored entries can start the first consecutive run, otherwise they are not scored
+    bool scoresIgnored = Scores(p).isEnabled(Criterion::ManyConsecutiveHours);
+    std::vector<size_t> result;
+    for (size_t gene = 0; gene < problem.getGeneCount(); gene++) {
+        if (scoresIgnored || !problem.isIgnored(gene)) {
+            result.push_back(gene);
+        }
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+/**
+ * @file solver.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Selection of engine for timetable generation by size of problem
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "evolution.h"
+#include "branchandbound.h"
+#include "Data/subjects.h"
+#include "Data/priorities.h"
+#include "Evolution/settings.h"
+#include "Evolution/problem.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <chrono>
+
+/**
+ * @brief Engine generating the timetable
+ *
+ */
+enum class SolverEngine {
+    Enumeration, //!< Scoring of every timetable
+    Exact, //!< Branch and bound search of timetables without collisions
+    Evolution //!< Genetic algorithm
+};
+
+/**
+ * @brief Size of problem and engine chosen for it
+ *
+ */
+struct SolverChoice {
+    SolverEngine engine; //!< Chosen engine
+    double searchSpace; //!< Number of all timetables (of schedules that are enumerated, see Solver::enumerate)
+    double tightness; //!< Ratio of colliding pairs of entries of different schedules
+    double expectedFeasible; //!< Estimated number of timetables without collisions
+    std::string reason; //!< Description of why the engine was chosen
+};
+
+/**
+ * @brief Front-end choosing engine for timetable generation
+ *
+ * Size of problem is estimated when semester is given: number of all timetables
+ * and ratio of colliding pairs of entries of each two schedules. Assuming collisions
+ * of different pairs of schedules are independent, the expected number of timetables
+ * without collisions is the number of all timetables times the ratio of pairs
+ * without collision of each two schedules.
+ *
+ * Tiny problems are enumerated, problems with few timetables without collisions
+ * are searched exactly (BranchAndBound) and only the rest is evolved.
+ * If exact search finds no timetable without collisions, evolution is used instead,
+ * so the timetable with fewest collisions is still generated.
+ *
+ */
+class Solver {
+
+    Semester semester; // Semester to generate timetable for
+    Priorities priorities; // Specified priorities for generation
+
+    std::function<void(size_t, size_t)> processing; // Function to be called after every generation of evolution
+    EvolutionSettings settings; // Settings of evolution
+    ExactSearchSettings exactSettings; // Limits of exact search
+
+    SolverChoice estimate; // Size of problem and engine chosen for it
+    SolverChoice choice; // Engine that generated the last timetable
+    std::unique_ptr<Evolution> evolution; // Evolution of the last solve (if it was used)
+
+public:
+
+    Solver() = delete;
+
+    /**
+     * @brief Construct a new Solver object and choose engine
+     *
+     * @param s semester for which a timetable will be generated
+     * @param p priorities for timetable generation
+     * @param proc function to be called after every generation of evolution,
+     * where first parameter is current progress value, second is max value
+     * @param e settings of evolution
+     * @param x limits of exact search
+     */
+    Solver(
+        const Semester & s,
+        const Priorities & p,
+        std::function<void(size_t, size_t)> proc = nullptr,
+        const EvolutionSettings & e = EvolutionSettings(),
+        const ExactSearchSettings & x = ExactSearchSettings());
+
+    /**
+     * @brief Generate timetable by chosen engine
+     *
+     * @throws std::invalid_argument generation size or number of generations is zero
+     *
+     * @param generationSize size of generation (if evolution is used)
+     * @param maxGenerations number of generations (if evolution is used)
+     * @param timeLimit milliseconds the generation can run (zero for no limit)
+     * @return std::vector<EvolutionResult> generated timetable
+     */
+    std::vector<EvolutionResult> solve(size_t generationSize, size_t maxGenerations, size_t timeLimit = 0);
+
+    /**
+     * @brief Get size of problem and chosen engine
+     *
+     * After solve, engine is the one that generated the timetable.
+     *
+     * @return const SolverChoice& choice
+     */
+    const SolverChoice & getChoice() const;
+
+    /**
+     * @brief Get evolution of the last solve
+     *
+     * @return const Evolution* evolution, nullptr if it was not used
+     */
+    const Evolution * getEvolution() const;
+
+    /**
+     * @brief Get size of genome
+     *
+     * @return size_t number of schedules
+     */
+    size_t getGenomeSize() const;
+
+    /**
+     * @brief Estimate size of problem and choose engine for it
+     *
+     * Number of all timetables counts the same schedules that enumeration goes through.
+     *
+     * @param s semester
+     * @param p priorities for timetable generation
+     * @return SolverChoice size of problem and chosen engine
+     */
+    static SolverChoice choose(const Semester & s, const Priorities & p);
+
+    /**
+     * @brief Get name of engine
+     *
+     * @param engine engine
+     * @return const char* name for user
+     */
+    static const char * describe(SolverEngine engine);
+
+private:
+
+    /**
+     * @brief Score every timetable and select the best one
+     *
+     * Entries of ignored schedules are enumerated too if many consecutive hours are penalised,
+     * because the first interval of timetable starts the first consecutive run. Otherwise they
+     * take part in no criterion and their first entry is selected.
+     *
+     * Deadline is checked every few timetables, when it passes the best timetable so far is returned.
+     *
+     * @param deadline time after which enumeration stops
+     * @return std::vector<EvolutionResult> best timetable
+     */
+    std::vector<EvolutionResult> enumerate(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Genes that enumeration goes through
+     *
+     * @param problem flat model of schedules
+     * @param p priorities for timetable generation
+     * @return std::vector<size_t> genes that are not ignored, and ignored genes if many consecutive hours are penalised
+     */
+    static std::vector<size_t> enumeratedGenes(const ProblemModel & problem, const Priorities & p);
+};
+
+#endif /* SOLVER_H */
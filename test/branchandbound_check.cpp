@@ -0,0 +1,167 @@
+/**
+ * @file branchandbound_check.cpp
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Check of exact search and enumeration against scoring of every timetable
+ *
+ * Small random semesters are generated and the best timetable without collisions
+ * is found by scoring every timetable, entries of ignored schedules included.
+ * Exact search has to find a timetable just as good and prove it is optimal.
+ * Solver enumerates such small semesters and has to find the best timetable
+ * of all, collisions included, after estimating as many timetables as it goes through.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "branchandbound.h"
+#include "solver.h"
+#include "Data/subjects.h"
+#include "Data/priorities.h"
+#include "Evolution/scores.h"
+#include "generate.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <algorithm>
+#include <random>
+
+// Number of random semesters checked
+#define CHECK_SEMESTER_COUNT 2000
+// Largest difference of fitness considered equal
+#define CHECK_EPSILON 1e-9
+
+/**
+ * @brief Score timetable like evolution does
+ *
+ * @param timetable selected entries
+ * @param priorities priorities of generation
+ * @param collisions number of collisions of timetable
+ * @return double fitness of timetable
+ */
+static double score(const std::vector<std::shared_ptr<Entry>> & timetable, const Priorities & priorities,
+    const Scores & lowerBounds, const Scores & upperBounds, double & collisions) {
+
+    std::vector<IntervalEntry> intervals;
+    for (auto & entry : timetable) {
+        for (auto & timeslot : entry->timeslots) {
+            intervals.emplace_back(timeslot, EntryProperties { entry->schedule.lock()->ignored, entry->getBonus() });
+        }
+    }
+
+    Scores scores(priorities);
+    scores.calculateScore(intervals, priorities);
+    collisions = scores[Criterion::Collisions];
+    return scores.convertScoreToFitness(lowerBounds, upperBounds);
+}
+
+int main() {
+    std::mt19937 random(2023);
+    size_t failures = 0;
+
+    // Few small schedules on three days, so every timetable can be scored
+    SemesterRanges ranges;
+    ranges.schedules = { 2, 5 };
+    ranges.entries = { 1, 4 };
+    ranges.timeslots = { 0, 2 };
+    ranges.days = { 0, 2 };
+    ranges.starts = { 28, 72 };
+    ranges.durations = { 3, 12 };
+    ranges.ignored = 1.0 / 3;
+
+    for (size_t i = 0; i < CHECK_SEMESTER_COUNT; i++) {
+        Semester semester = generateSemester(ranges, random);
+
+        Priorities priorities;
+        priorities.penaliseBeforeHour = std::uniform_int_distribution<int>(0, 1)(random) * 9;
+        priorities.penaliseAfterHour = std::uniform_int_distribution<int>(0, 1)(random) * 16;
+        priorities.penaliseManyConsecutiveHours = std::uniform_int_distribution<int>(0, 3)(random);
+
+        Scores lowerBounds(priorities);
+        Scores upperBounds(priorities);
+        lowerBounds.setToLowerBounds(semester.schedulePtrs, priorities);
+        upperBounds.setToUpperBounds(semester.schedulePtrs, priorities);
+
+        // Score every timetable like an odometer
+        std::vector<size_t> indices(semester.schedulePtrs.size(), 0);
+        std::vector<std::shared_ptr<Entry>> timetable;
+        bool feasible = false;
+        double bestFitness = 0;
+        double bestOverall = -std::numeric_limits<double>::max();
+        do {
+            timetable.clear();
+            for (size_t j = 0; j < indices.size(); j++) {
+                timetable.push_back(semester.schedulePtrs[j]->entriesPtrs[indices[j]]);
+            }
+
+            double collisions;
+            double fitness = score(timetable, priorities, lowerBounds, upperBounds, collisions);
+            bestOverall = std::max(bestOverall, fitness);
+            if (collisions == 0 && (!feasible || fitness > bestFitness)) {
+                feasible = true;
+                bestFitness = fitness;
+            }
+
+            size_t j = 0;
+            while (j < indices.size() && ++indices[j] == semester.schedulePtrs[j]->entriesPtrs.size()) {
+                indices[j] = 0;
+                j++;
+            }
+            if (j == indices.size()) {
+                break;
+            }
+        } while (true);
+
+        BranchAndBound branchAndBound(semester, priorities);
+        std::vector<EvolutionResult> result = branchAndBound.solve();
+
+        timetable.clear();
+        for (auto & selected : result) {
+            timetable.push_back(selected.second);
+        }
+        double collisions = 0;
+        double fitness = result.empty() ? 0 : score(timetable, priorities, lowerBounds, upperBounds, collisions);
+
+        bool correct = feasible
+            ? branchAndBound.getStatus() == SearchStatus::Optimal && collisions == 0 && std::abs(fitness - bestFitness) < CHECK_EPSILON
+            : branchAndBound.getStatus() == SearchStatus::Infeasible && result.empty();
+        if (!correct) {
+            std::printf("Semester %zu: exact search found fitness %.9f (status %d), best is %.9f%s\n", i, fitness,
+                static_cast<int>(branchAndBound.getStatus()), bestFitness, feasible ? "" : " (no timetable without collisions)");
+            failures++;
+        }
+
+        // Enumeration goes through ignored schedules only if they can start the first consecutive run
+        double searchSpace = 1;
+        for (auto & schedule : semester.schedulePtrs) {
+            if (!schedule->ignored || priorities.penaliseManyConsecutiveHours != 0) {
+                searchSpace *= schedule->entriesPtrs.size();
+            }
+        }
+
+        Solver solver(semester, priorities);
+        if (solver.getChoice().searchSpace != searchSpace) {
+            std::printf("Semester %zu: solver estimated %.0f timetables, enumeration goes through %.0f\n", i,
+                solver.getChoice().searchSpace, searchSpace);
+            failures++;
+        }
+        result = solver.solve(1, 1);
+
+        timetable.clear();
+        for (auto & selected : result) {
+            timetable.push_back(selected.second);
+        }
+        fitness = score(timetable, priorities, lowerBounds, upperBounds, collisions);
+
+        if (solver.getChoice().engine != SolverEngine::Enumeration || std::abs(fitness - bestOverall) >= CHECK_EPSILON) {
+            std::printf("Semester %zu: %s found fitness %.9f, best is %.9f\n", i,
+                Solver::describe(solver.getChoice().engine), fitness, bestOverall);
+            failures++;
+        }
+    }
+
+    std::printf("%zu of %d semesters failed\n", failures, CHECK_SEMESTER_COUNT);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file distributed_check.cpp
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Check of messages between processes and of island evolution in worker processes
+ *
+ * Migrants have to survive serialization unchanged, malformed messages (truncated,
+ * with gene out of range) have to be rejected, and framed messages have to be
+ * taken from a socket only when they arrived whole. Evolution on two worker
+ * processes has to return a valid timetable of a small semester.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "distributed.h"
+#include "Data/subjects.h"
+#include "Data/priorities.h"
+#include "Evolution/scores.h"
+#include "Utility/channel.h"
+#include "generate.h"
+
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+#include <sys/socket.h>
+
+// Entries of the large schedule, more than one byte is needed for its genes
+#define CHECK_LARGE_SCHEDULE_SIZE 300
+// Number of random migrants serialized
+#define CHECK_MIGRANT_COUNT 200
+
+/**
+ * @brief Check that deserialization rejects data
+ *
+ * @param evolution evolution deserializing data
+ * @param data malformed data
+ * @return true data were rejected
+ */
+static bool rejects(const ProcessIslandEvolution & evolution, const std::vector<uint8_t> & data) {
+    try {
+        evolution.deserialize(data);
+    }
+    catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    std::mt19937 random(2023);
+    size_t failures = 0;
+
+    // Small semester with one large schedule, more than one byte is needed for its genes
+    SemesterRanges ranges;
+    ranges.schedules = { 6, 6 };
+    ranges.timeslots = { 1, 1 };
+    ranges.days = { 0, 4 };
+    ranges.parities = { 2, 2 };
+    ranges.starts = { 28, 72 };
+    ranges.durations = { 3, 12 };
+    ranges.bonuses = { 0, 0 };
+    ranges.ignored = 0;
+
+    Semester semester = generateSemester(ranges, random);
+    std::shared_ptr<Schedule> large = semester.schedulePtrs.front();
+    for (size_t j = large->entriesPtrs.size(); j < CHECK_LARGE_SCHEDULE_SIZE; j++) {
+        large->entriesPtrs.push_back(generateEntry(large, j, ranges, random));
+    }
+    Priorities priorities;
+    priorities.keepCoherentInDay = true;
+    priorities.penaliseManyConsecutiveHours = 2;
+
+    EvolutionSettings settings;
+    settings.seed = 2023;
+    IslandSettings islandSettings;
+    islandSettings.islandCount = 2;
+    islandSettings.migrationInterval = 2;
+    ProcessIslandEvolution evolution(semester, priorities, nullptr, settings, islandSettings);
+
+    // Random migrants, genes of the large schedule need one or two bytes
+    std::vector<Migrant> migrants;
+    for (size_t i = 0; i < CHECK_MIGRANT_COUNT; i++) {
+        Migrant migrant { Genome(semester.schedulePtrs.size()), Scores(priorities) };
+        for (size_t gene = 0; gene < migrant.genome.size(); gene++) {
+            size_t valueCount = semester.schedulePtrs[gene]->entriesPtrs.size();
+            migrant.genome[gene] = std::uniform_int_distribution<uint32_t>(0, valueCount - 1)(random);
+        }
+        for (size_t c = 0; c < CRITERIA_COUNT; c++) {
+            if (migrant.scores.isEnabled(static_cast<Criterion>(c))) {
+                migrant.scores.values[c] = std::uniform_real_distribution<double>(-100, 100)(random);
+            }
+        }
+        migrants.push_back(migrant);
+    }
+
+    std::vector<uint8_t> data = ProcessIslandEvolution::serialize(migrants);
+    std::vector<Migrant> received = evolution.deserialize(data);
+    bool same = received.size() == migrants.size();
+    for (size_t i = 0; same && i < migrants.size(); i++) {
+        same = received[i].genome == migrants[i].genome && received[i].scores.enabled == migrants[i].scores.enabled
+            && received[i].scores.values == migrants[i].scores.values;
+    }
+    if (!same) {
+        std::printf("Deserialized migrants differ from serialized ones\n");
+        failures++;
+    }
+
+    // Every truncation of a message is rejected
+    for (size_t length = 0; length < data.size(); length += 97) {
+        if (!rejects(evolution, std::vector<uint8_t>(data.begin(), data.begin() + length))) {
+            std::printf("Message truncated to %zu of %zu bytes was accepted\n", length, data.size());
+            failures++;
+        }
+    }
+    if (!rejects(evolution, std::vector<uint8_t>(data.begin(), data.end() - 1))) {
+        std::printf("Message without its last byte was accepted\n");
+        failures++;
+    }
+
+    // Gene out of range of its schedule is rejected
+    Migrant outOfRange = migrants.front();
+    outOfRange.genome.back() = semester.schedulePtrs.back()->entriesPtrs.size();
+    if (!rejects(evolution, ProcessIslandEvolution::serialize({ outOfRange }))) {
+        std::printf("Message with gene out of range was accepted\n");
+        failures++;
+    }
+
+    // Messages are taken only when they arrived whole, in the order they were sent
+    std::pair<int, int> sockets = MessageChannel::createSocketPair();
+    MessageChannel sender(sockets.first);
+    MessageChannel receiver(sockets.second);
+
+    sender.send(1, data);
+    sender.send(2, std::vector<uint8_t>());
+    uint8_t partial[] = { 3, 2, 0, 0, 0, 42 }; // Header of two bytes of payload and one of them
+    ::send(sender.getDescriptor(), partial, sizeof(partial), 0);
+
+    receiver.fill();
+    std::optional<Message> first = receiver.next();
+    std::optional<Message> second = receiver.next();
+    std::optional<Message> incomplete = receiver.next();
+    if (!first.has_value() || first->type != 1 || first->payload != data
+        || !second.has_value() || second->type != 2 || !second->payload.empty() || incomplete.has_value()) {
+        std::printf("Channel did not deliver whole messages in order\n");
+        failures++;
+    }
+
+    uint8_t rest[] = { 43 };
+    ::send(sender.getDescriptor(), rest, sizeof(rest), 0);
+    receiver.fill();
+    std::optional<Message> completed = receiver.next();
+    if (!completed.has_value() || completed->type != 3 || completed->payload != std::vector<uint8_t> { 42, 43 }) {
+        std::printf("Channel did not deliver message completed later\n");
+        failures++;
+    }
+
+    // Evolution on two worker processes with migration
+    try {
+        std::vector<EvolutionResult> result = evolution.evolve(20, 10);
+        bool valid = result.size() == semester.schedulePtrs.size();
+        for (size_t i = 0; valid && i < result.size(); i++) {
+            const Schedule & schedule = *semester.schedulePtrs[i];
+            valid = result[i].first == EntryAddress(schedule.course, schedule.name)
+                && result[i].second != nullptr && result[i].second->schedule.lock().get() == &schedule;
+        }
+        if (!valid) {
+            std::printf("Evolution in worker processes returned invalid timetable\n");
+            failures++;
+        }
+    }
+    catch (const std::exception & e) {
+        std::printf("Evolution in worker processes failed: %s\n", e.what());
+        failures++;
+    }
+
+    std::printf("%zu checks of messages and worker processes failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file generate.h
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Generation of random semesters for checks
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include "Data/subjects.h"
+
+#include <memory>
+#include <random>
+#include <string>
+
+/**
+ * @brief Inclusive range of random integers
+ *
+ */
+struct Range {
+    int min; //!< Smallest value
+    int max; //!< Largest value
+
+    /**
+     * @brief Draw value from range
+     *
+     * @param random generator
+     * @return int value with uniform distribution
+     */
+    int draw(std::mt19937 & random) const {
+        return std::uniform_int_distribution<int>(min, max)(random);
+    }
+};
+
+/**
+ * @brief Ranges of random semester
+ *
+ * Each check changes only the ranges its semesters differ in.
+ *
+ */
+struct SemesterRanges {
+    Range schedules { 1, 12 }; //!< Number of schedules
+    Range entries { 1, 5 }; //!< Number of entries of each schedule
+    Range timeslots { 0, 3 }; //!< Number of timeslots of each entry
+    Range days { 0, 6 }; //!< Day of timeslot (0 is monday)
+    Range parities { 0, 2 }; //!< Parity of timeslot (0 even, 1 odd, 2 both)
+    Range starts { 28, 76 }; //!< Start of timeslot in quarters of hour
+    Range durations { 1, 12 }; //!< Length of timeslot in quarters of hour
+    Range bonuses { -4, 4 }; //!< Bonus of entry in halves
+    double ignored = 0.25; //!< Probability of schedule being ignored
+};
+
+/**
+ * @brief Generate random entry
+ *
+ * @param schedule schedule of entry
+ * @param index index of entry in schedule
+ * @param ranges ranges of semester
+ * @param random generator
+ * @return std::shared_ptr<Entry> entry, not yet added to schedule
+ */
+inline std::shared_ptr<Entry> generateEntry(const std::shared_ptr<Schedule> & schedule, size_t index,
+    const SemesterRanges & ranges, std::mt19937 & random) {
+
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>(index, schedule);
+    entry->setBonus(ranges.bonuses.draw(random) * 0.5);
+
+    int timeslotCount = ranges.timeslots.draw(random);
+    for (int k = 0; k < timeslotCount; k++) {
+        auto day = static_cast<TimeInterval::Day>(ranges.days.draw(random));
+        uint32_t start = ranges.starts.draw(random) * 15;
+        uint32_t end = start + ranges.durations.draw(random) * 15;
+        auto parity = static_cast<TimeInterval::Parity>(ranges.parities.draw(random));
+        entry->timeslots.emplace_back(day, TimeInterval::TimeStamp(start / 60, start % 60),
+            TimeInterval::TimeStamp(end / 60, end % 60), parity);
+    }
+
+    return entry;
+}
+
+/**
+ * @brief Generate random semester
+ *
+ * @param ranges ranges of semester
+ * @param random generator
+ * @return Semester semester
+ */
+inline Semester generateSemester(const SemesterRanges & ranges, std::mt19937 & random) {
+    Semester result;
+
+    int scheduleCount = ranges.schedules.draw(random);
+    for (int i = 0; i < scheduleCount; i++) {
+        std::shared_ptr<Schedule> schedule = std::make_shared<Schedule>("S" + std::to_string(i));
+        schedule->course = "C" + std::to_string(i);
+        schedule->ignored = std::bernoulli_distribution(ranges.ignored)(random);
+
+        int entryCount = ranges.entries.draw(random);
+        for (int j = 0; j < entryCount; j++) {
+            schedule->entriesPtrs.push_back(generateEntry(schedule, j, ranges, random));
+        }
+
+        result.schedulePtrs.push_back(schedule);
+    }
+
+    return result;
+}
+
+#endif /* GENERATE_H */
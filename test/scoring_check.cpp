@@ -0,0 +1,159 @@
+/**
+ * @file scoring_check.cpp
+ * @author Michal Dobes
+ * @date 2023-08-13
+ *
+ * @brief Check of fused and incremental scoring against the reference Score classes
+ *
+ * Random semesters are generated with overlapping timeslots of all parities, ignored
+ * schedules and bonuses, and scored with random priorities. Scores of random genomes
+ * calculated by ScoreEvaluator, and scores of the same genomes with one gene changed
+ * calculated by IncrementalScorer, have to match Scores::calculateScore. So do scores
+ * kept by IncrementalScorer while genes of its genome are changed one after another.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "Data/subjects.h"
+#include "Data/priorities.h"
+#include "Evolution/problem.h"
+#include "Evolution/evaluator.h"
+#include "Evolution/incremental.h"
+#include "Evolution/scores.h"
+#include "generate.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Number of random semesters checked
+#define CHECK_SEMESTER_COUNT 2000
+// Number of random genomes scored in each semester
+#define CHECK_GENOME_COUNT 20
+// Number of single-gene changes scored for each genome
+#define CHECK_CHANGE_COUNT 10
+// Relative difference allowed, bonuses may be summed in different order
+#define CHECK_TOLERANCE 1e-9
+
+/**
+ * @brief Generate random priorities
+ *
+ * @param random generator
+ * @return Priorities priorities with random criteria enabled
+ */
+static Priorities generatePriorities(std::mt19937 & random) {
+    Priorities result;
+    result.keepCoherentInDay = std::uniform_int_distribution<int>(0, 1)(random) == 1;
+    result.keepCoherentInWeek = std::uniform_int_distribution<int>(0, 1)(random) == 1;
+    result.penaliseBeforeHour = std::uniform_int_distribution<int>(0, 1)(random) * std::uniform_int_distribution<int>(7, 10)(random);
+    result.penaliseAfterHour = std::uniform_int_distribution<int>(0, 1)(random) * std::uniform_int_distribution<int>(14, 18)(random);
+    result.penaliseManyConsecutiveHours = std::uniform_int_distribution<int>(0, 4)(random);
+    result.minutesToBeConsecutive = std::uniform_int_distribution<unsigned int>(0, 4)(random) * 15;
+    return result;
+}
+
+/**
+ * @brief Score genome by the reference Score classes
+ *
+ * @param problem flat model of schedules
+ * @param genome genome
+ * @param priorities priorities of generation
+ * @return Scores scores
+ */
+static Scores referenceScore(const ProblemModel & problem, const Genome & genome, const Priorities & priorities) {
+    std::vector<IntervalEntry> intervals;
+    for (size_t gene = 0; gene < genome.size(); gene++) {
+        size_t entry = problem.entryIndex(gene, genome[gene]);
+        EntryProperties properties { problem.isIgnored(gene), problem.bonus(entry) };
+        for (auto & timeslot : problem.timeslots(entry)) {
+            intervals.emplace_back(timeslot, properties);
+        }
+    }
+
+    Scores result(priorities);
+    result.calculateScore(intervals, priorities);
+    return result;
+}
+
+/**
+ * @brief Compare scores and print difference
+ *
+ * @param what calculation that is checked
+ * @param semester index of semester
+ * @param scores scores to be checked
+ * @param reference reference scores
+ * @return true scores match
+ */
+static bool compare(const char * what, size_t semester, const Scores & scores, const Scores & reference) {
+    bool result = scores.enabled == reference.enabled;
+    for (size_t c = 0; c < CRITERIA_COUNT; c++) {
+        double tolerance = std::abs(reference.values[c]) * CHECK_TOLERANCE;
+        if (std::abs(scores.values[c] - reference.values[c]) > tolerance) {
+            std::printf("Semester %zu: %s gives %s %.9f, reference %.9f\n", semester, what,
+                CRITERIA[c].name, scores.values[c], reference.values[c]);
+            result = false;
+        }
+    }
+    return result;
+}
+
+int main() {
+    std::mt19937 random(2023);
+    size_t failures = 0;
+
+    // Overlapping timeslots of all parities on all days, some schedules ignored
+    SemesterRanges ranges;
+
+    for (size_t i = 0; i < CHECK_SEMESTER_COUNT; i++) {
+        Semester semester = generateSemester(ranges, random);
+        Priorities priorities = generatePriorities(random);
+
+        ProblemModel problem(semester.schedulePtrs);
+        ScoreEvaluator evaluator(problem, priorities);
+        ScoreEvaluator::Workspace workspace;
+        IncrementalScorer scorer(problem, priorities);
+
+        bool correct = true;
+        for (size_t j = 0; j < CHECK_GENOME_COUNT; j++) {
+            Genome genome(problem.getGeneCount());
+            for (size_t gene = 0; gene < genome.size(); gene++) {
+                genome[gene] = std::uniform_int_distribution<uint32_t>(0, problem.valueCount(gene) - 1)(random);
+            }
+
+            correct &= compare("fused evaluation", i, evaluator.evaluate(genome, workspace), referenceScore(problem, genome, priorities));
+
+            // Genome with one gene changed, scored without changing the genome of scorer
+            scorer.reset(genome);
+            for (size_t k = 0; k < CHECK_CHANGE_COUNT; k++) {
+                size_t gene = std::uniform_int_distribution<size_t>(0, genome.size() - 1)(random);
+                uint32_t value = std::uniform_int_distribution<uint32_t>(0, problem.valueCount(gene) - 1)(random);
+
+                Genome changed = genome;
+                changed[gene] = value;
+                correct &= compare("incremental change", i, scorer.getScoresWith(gene, value), referenceScore(problem, changed, priorities));
+            }
+
+            // Genes of scorer changed one after another, scores are kept up to date
+            for (size_t k = 0; k < CHECK_CHANGE_COUNT; k++) {
+                size_t gene = std::uniform_int_distribution<size_t>(0, genome.size() - 1)(random);
+                uint32_t value = std::uniform_int_distribution<uint32_t>(0, problem.valueCount(gene) - 1)(random);
+
+                genome[gene] = value;
+                scorer.change(gene, value);
+                if (scorer.getGenome() != genome) {
+                    std::printf("Semester %zu: incremental scorer has different genome after change\n", i);
+                    correct = false;
+                }
+                correct &= compare("incremental scores after changes", i, scorer.getScores(), referenceScore(problem, genome, priorities));
+            }
+        }
+
+        if (!correct) {
+            failures++;
+        }
+    }
+
+    std::printf("%zu of %d semesters failed\n", failures, CHECK_SEMESTER_COUNT);
+    return failures == 0 ? 0 : 1;
+}